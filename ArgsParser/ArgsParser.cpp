@@ -1,5 +1,11 @@
 #include "ArgsParser.h"
 #include "../TSPLIB/tsplib.h"
+#include "../Server/Server.h"
+#include "../Distributed/Coordinator.h"
+#include "../Distributed/Worker.h"
+#include "../Cache/ResultCache.h"
+#include "../Little/Little.h"
+#include <memory>
 
 using std::ifstream;
 using std::ofstream;
@@ -7,6 +13,49 @@ using std::cout;
 using std::endl;
 
 void ArgsParser::exec() {
+    string cacheParam = getParam("-c");
+    std::unique_ptr<ResultCache> cache;
+    if (cacheParam != "") {
+        // -c option, results kept on disk across runs
+        cache.reset(new ResultCache(cacheParam, hasFlag("--cache-relabel")));
+    }
+
+    string memoryLimitParam = getParam("--memory-limit");
+    size_t memoryLimit = 0;
+    if (memoryLimitParam != "") {
+        // --memory-limit option, megabytes of open nodes kept in memory, the others are spilled to disk
+        double megabytes = std::atof(memoryLimitParam.c_str());
+        if (megabytes <= 0) {
+            cout << "Error : Invalid memory limit " << memoryLimitParam << endl;
+            return;
+        }
+        memoryLimit = (size_t) (megabytes * 1024 * 1024);
+    }
+
+    string workerParam = getParam("--worker");
+    if (workerParam != "") {
+        // --worker option, solves the subproblems of a coordinator
+        size_t colon = workerParam.rfind(':');
+        if (colon == string::npos) {
+            cout << "Error : --worker expects <host>:<port>" << endl;
+            return;
+        }
+        Worker worker(workerParam.substr(0, colon), std::atoi(workerParam.substr(colon + 1).c_str()));
+        worker.setMemoryLimit(memoryLimit);
+        worker.run();
+        return;
+    }
+
+    string socketParam = getParam("-s");
+    if (socketParam != "") {
+        // -s option, solver daemon
+        string workersParam = getParam("-w");
+        Server server(socketParam, workersParam != "" ? std::atoi(workersParam.c_str()) : 0);
+        server.setCache(cache.get());
+        server.run();
+        return;
+    }
+
     string inputParam = getParam("-i");
     string outputParam = getParam("-o");
     if (inputParam == "") {
@@ -20,6 +69,60 @@ void ArgsParser::exec() {
         return;
     }
 
+    Tsplib tsp;
+    tsp.setCache(cache.get());
+    string branchingParam = getParam("--branching");
+    if (branchingParam != "") {
+        // --branching option, choice of the segment to branch on
+        string candidatesParam = getParam("--strong-candidates");
+        std::shared_ptr<BranchingRule<int> > rule = makeBranchingRule<int>(branchingParam,
+                candidatesParam != "" ? std::atoi(candidatesParam.c_str()) : 5);
+        if (!rule) {
+            cout << "Error : Unknown branching rule " << branchingParam << endl;
+            return;
+        }
+        tsp.setBranchingRule(rule);
+    }
+    string boundParam = getParam("--bound");
+    if (boundParam != "") {
+        // --bound option, reduction or assignment problem lower bound
+        if (boundParam != "reduction" and boundParam != "ap") {
+            cout << "Error : Unknown bound " << boundParam << endl;
+            return;
+        }
+        tsp.setAssignmentBound(boundParam == "ap");
+    }
+    tsp.setMemoryLimit(memoryLimit);
+    string ttSizeParam = getParam("--tt-size");
+    if (ttSizeParam != "") {
+        // --tt-size option, megabytes of the table pruning the subproblems reached again
+        double megabytes = std::atof(ttSizeParam.c_str());
+        if (megabytes <= 0) {
+            cout << "Error : Invalid transposition table size " << ttSizeParam << endl;
+            return;
+        }
+        tsp.setTranspositionTableSize((size_t) (megabytes * 1024 * 1024));
+    }
+    string kernelSizeParam = getParam("--kernel-size");
+    if (kernelSizeParam != "") {
+        // --kernel-size option, subproblems of at most this many cities searched on fixed size matrices
+        int kernelSize = std::atoi(kernelSizeParam.c_str());
+        if (kernelSize < 0 or kernelSize > Little<int>::maxKernelSize) {
+            cout << "Error : Kernel size must be between 0 and " << Little<int>::maxKernelSize << endl;
+            return;
+        }
+        tsp.setKernelSize(kernelSize);
+    }
+    string decomposeParam = getParam("--decompose");
+    if (decomposeParam != "") {
+        // --decompose option, approximate tour by exact searches on clusters of at most this many cities
+        int clusterSize = std::atoi(decomposeParam.c_str());
+        if (clusterSize < 3) {
+            cout << "Error : Cluster size must be at least 3" << endl;
+            return;
+        }
+        tsp.setClusterSize(clusterSize);
+    }
     if (outputParam != "") {
         ofstream outputFile(outputParam);
         if (!outputFile) {
@@ -29,16 +132,115 @@ void ArgsParser::exec() {
         }
 
         // -i and -o options
-        Tsplib tsp(inputFile, outputFile);
+        if (prepare(tsp, inputFile) and solve(tsp)) {
+            tsp.writeSolution(outputFile);
+        }
         outputFile.close();
     }
     else {
         // -i but no -o option
-        Tsplib tsp(inputFile);
+        if (prepare(tsp, inputFile) and solve(tsp)) {
+            tsp.printSolution();
+        }
     }
     inputFile.close();
 }
 
+// Read the problem and the optional initial tour, return false on error
+bool ArgsParser::prepare(Tsplib &tsp, ifstream &inputFile) {
+    if (!tsp.readProblem(inputFile)) {
+        return false;
+    }
+
+    string initialTourParam = getParam("--initial-tour");
+    if (initialTourParam != "") {
+        ifstream tourFile(initialTourParam);
+        if (!tourFile) {
+            cout << "Error : Initial tour file not found" << endl;
+            return false;
+        }
+        if (!tsp.readInitialTour(tourFile)) {
+            return false;
+        }
+    }
+
+    string deltaParam = getParam("--delta");
+    if (deltaParam != "") {
+        // --delta option, re-optimization of the initial tour after the edits
+        if (initialTourParam == "") {
+            cout << "Error : --delta requires --initial-tour" << endl;
+            return false;
+        }
+        ifstream deltaFile(deltaParam);
+        if (!deltaFile) {
+            cout << "Error : Delta file not found" << endl;
+            return false;
+        }
+        if (!tsp.readDelta(deltaFile)) {
+            return false;
+        }
+        tsp.setInitialOptimal(hasFlag("--initial-optimal"));
+        string nodeLimitParam = getParam("--node-limit");
+        if (nodeLimitParam != "") {
+            tsp.setNodeLimit(std::atol(nodeLimitParam.c_str()));
+        }
+    }
+    return true;
+}
+
+/*
+ * Solve the problem, spread over worker processes with the --coordinator
+ * option, return false on error
+ */
+bool ArgsParser::solve(Tsplib &tsp) {
+    string coordinatorParam = getParam("--coordinator");
+    if (coordinatorParam == "") {
+        tsp.solve();
+        return true;
+    }
+    if (tsp.hasDelta()) {
+        cout << "Error : --delta cannot be used with --coordinator" << endl;
+        return false;
+    }
+    if (getParam("--decompose") != "") {
+        cout << "Error : --decompose cannot be used with --coordinator" << endl;
+        return false;
+    }
+    if (getParam("--memory-limit") != "") {
+        cout << "Error : --memory-limit cannot be used with --coordinator, it is given to the workers" << endl;
+        return false;
+    }
+    if (getParam("-c") != "") {
+        cout << "Error : -c cannot be used with --coordinator" << endl;
+        return false;
+    }
+
+    string depthParam = getParam("--split-depth");
+    string boundParam = getParam("--bound");
+    string branchingParam = getParam("--branching");
+    string candidatesParam = getParam("--strong-candidates");
+    Coordinator coordinator(tsp.getMatrix(), std::atoi(coordinatorParam.c_str()),
+                            depthParam != "" ? std::atoi(depthParam.c_str()) : 8,
+                            boundParam != "" ? boundParam : "reduction",
+                            branchingParam != "" ? branchingParam : "regret",
+                            candidatesParam != "" ? std::atoi(candidatesParam.c_str()) : 5);
+
+    // Options of the searches of the workers, checked by exec
+    string kernelSizeParam = getParam("--kernel-size");
+    if (kernelSizeParam != "") {
+        coordinator.setKernelSize(std::atoi(kernelSizeParam.c_str()));
+    }
+    string ttSizeParam = getParam("--tt-size");
+    if (ttSizeParam != "") {
+        coordinator.setTranspositionTableSize((size_t) (std::atof(ttSizeParam.c_str()) * 1024 * 1024));
+    }
+    if (!coordinator.run(tsp.getInitialTour())) {
+        return false;
+    }
+    tsp.setSolution(coordinator.getTour(), coordinator.getCost(), coordinator.isOptimal());
+    return true;
+}
+
 string ArgsParser::getParam(string cmd) {
     for (int i = 0; i < argc; i++) {
         if (argv[i] == cmd && i < argc - 1) {
@@ -46,4 +248,14 @@ string ArgsParser::getParam(string cmd) {
         }
     }
     return "";
+}
+
+// Return whether a flag without value has been submitted
+bool ArgsParser::hasFlag(string cmd) {
+    for (int i = 0; i < argc; i++) {
+        if (argv[i] == cmd) {
+            return true;
+        }
+    }
+    return false;
 }
\ No newline at end of file
@@ -2,18 +2,25 @@
 #define	ARGSPARSER_H
 
 #include <string>
+#include <fstream>
 
 using std::string;
 
+class Tsplib;
+
 class ArgsParser {
 private:
     int argc;
     char** argv;
+
+    bool prepare(Tsplib&, std::ifstream&);
+    bool solve(Tsplib&);
     
 public:
     ArgsParser(int argc, char** argv) : argc(argc), argv(argv) {}
     void exec();
     string getParam(string);
+    bool hasFlag(string);
 };
 
 
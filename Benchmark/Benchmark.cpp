@@ -0,0 +1,65 @@
+#include "../TSPLIB/tsplib.h"
+#include "../Little/Little.h"
+#include <chrono>
+#include <cstdlib>
+
+using std::cout;
+using std::endl;
+
+/*
+ * Solve each submitted TSPlib problem with each branching rule,
+ * and report the size of the search tree and the running time
+ *
+ * Usage : LittleBenchmark [--strong-candidates <k>] [--bound reduction|ap] <problem> ...
+ */
+int main(int argc, char** argv) {
+    int nbCandidates = 5;
+    bool assignmentBound = false;
+    vector<string> problems;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--strong-candidates" and i < argc - 1) {
+            nbCandidates = std::atoi(argv[++i]);
+        }
+        else if (string(argv[i]) == "--bound" and i < argc - 1) {
+            assignmentBound = (string(argv[++i]) == "ap");
+        }
+        else {
+            problems.push_back(argv[i]);
+        }
+    }
+    if (problems.empty()) {
+        cout << "Usage : " << argv[0] << " [--strong-candidates <k>] [--bound reduction|ap] <problem> ..." << endl;
+        return 1;
+    }
+
+    vector<string> rules = {"regret", "tie", "strong"};
+    if (assignmentBound) {
+        rules.push_back("subtour");
+    }
+    cout << "problem\trule\tnodes\tseconds\tcost" << endl;
+    for (const string &problem : problems) {
+        ifstream inputFile(problem);
+        Tsplib tsp;
+        if (!inputFile or !tsp.readProblem(inputFile)) {
+            cout << "Error : " << problem << " cannot be read" << endl;
+            continue;
+        }
+        Matrix<int> matrix = tsp.getMatrix();
+
+        for (const string &rule : rules) {
+            Little<int> little(matrix);
+            little.setVerbose(false);
+            little.setBranchingRule(makeBranchingRule<int>(rule, nbCandidates));
+            little.setAssignmentBound(assignmentBound);
+            little.setSymmetric(true);      // kept asymmetric unless the costs are symmetric
+            little.setKernelSize(0);        // the kernels only implement the regret rule, the rules are compared without them
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            little.findTour();
+            double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            cout << problem << "\t" << rule << "\t" << little.getNbNodes() << "\t" << duration << "\t" << little.getCost() << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include "ResultCache.h"
+#include "../TSPLIB/tsplib.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cstdio>
+#include <sys/stat.h>
+
+using std::ifstream;
+using std::ofstream;
+using std::stringstream;
+using std::endl;
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// Add a value to a 64 bits FNV-1a hash
+static uint64_t mix(uint64_t h, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        h ^= (value >> (i * 8)) & 0xff;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+ResultCache::ResultCache(string directory, bool detectRelabel) : directory(directory), detectRelabel(detectRelabel) {
+    mkdir(directory.c_str(), 0755);
+}
+
+/*
+ * Hash of the matrix with its cities taken in the given order,
+ * the diagonal is ignored
+ */
+uint64_t ResultCache::matrixHash(Matrix<int> &m, const vector<int> &order) {
+    int size = order.size();
+    uint64_t h = mix(FNV_OFFSET, size);
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if (i != j) {
+                h = mix(h, (uint32_t) m.getValue(order[i], order[j]));
+            }
+        }
+    }
+    return h;
+}
+
+// Signature of each city, made of its sorted outgoing and incoming costs
+vector<uint64_t> ResultCache::citySignatures(Matrix<int> &m) {
+    int size = m.getNbRows();
+    vector<uint64_t> signatures(size);
+    vector<int> out, in;
+    for (int i = 0; i < size; i++) {
+        out.clear();
+        in.clear();
+        for (int j = 0; j < size; j++) {
+            if (i != j) {
+                out.push_back(m.getValue(i, j));
+                in.push_back(m.getValue(j, i));
+            }
+        }
+        std::sort(out.begin(), out.end());
+        std::sort(in.begin(), in.end());
+        uint64_t h = FNV_OFFSET;
+        for (int value : out) {
+            h = mix(h, (uint32_t) value);
+        }
+        h = mix(h, UINT64_MAX);
+        for (int value : in) {
+            h = mix(h, (uint32_t) value);
+        }
+        signatures[i] = h;
+    }
+    return signatures;
+}
+
+// Hash of the city signatures, whatever the city numbering
+uint64_t ResultCache::invariantHash(vector<uint64_t> signatures) {
+    std::sort(signatures.begin(), signatures.end());
+    uint64_t h = mix(FNV_OFFSET, signatures.size());
+    for (uint64_t signature : signatures) {
+        h = mix(h, signature);
+    }
+    return h;
+}
+
+string ResultCache::toHex(uint64_t value) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long) value);
+    return buffer;
+}
+
+// Read the stored tour of a problem, return false if there is none
+bool ResultCache::readEntry(uint64_t key, int nbCities, CacheEntry &entry) {
+    ifstream file(tourPath(key));
+    string comment;
+    if (!file or !Tsplib::readTour(file, entry.tour, comment) or entry.tour.size() != nbCities) {
+        return false;
+    }
+    for (int city : entry.tour) {
+        if (city < 1 or city > nbCities) {
+            return false;
+        }
+    }
+
+    // COMMENT : Length = <cost> OPTIMAL|FEASIBLE
+    stringstream stream(comment);
+    string length, equal, status;
+    if (!(stream >> length >> equal >> entry.cost >> status)) {
+        return false;
+    }
+    entry.optimal = (status == "OPTIMAL");
+    return true;
+}
+
+/*
+ * Return whether the entry is a tour of the problem of the stored cost, a
+ * hash collision or an edited file being otherwise taken for its result
+ */
+bool ResultCache::isValid(Matrix<int> &m, const CacheEntry &entry) {
+    int size = m.getNbRows();
+    if (entry.tour.size() != size) {
+        return false;
+    }
+    vector<bool> visited(size, false);
+    long cost = 0;
+    for (int i = 0; i < size; i++) {
+        int from = entry.tour[i] - 1;
+        int to = entry.tour[(i + 1) % size] - 1;
+        if (from < 0 or from >= size or visited[from]) {
+            return false;
+        }
+        visited[from] = true;
+        if (size > 1) {
+            int value = m.getValue(from, to);
+            if (value == m.getEmptyValue()) {
+                return false;
+            }
+            cost += value;
+        }
+    }
+    return cost == entry.cost;
+}
+
+/*
+ * Look for a relabelled copy of the problem among the stored ones
+ * sharing its invariant hash. Only the problems whose cities all have
+ * a distinct signature are recognized, the numbering is then deduced
+ * from the signatures and checked against the stored matrix hash
+ */
+bool ResultCache::findRelabelled(Matrix<int> &m, CacheEntry &entry) {
+    vector<uint64_t> signatures = citySignatures(m);
+    ifstream index(indexPath(invariantHash(signatures)));
+    if (!index) {
+        return false;
+    }
+
+    std::map<uint64_t, int> cityBySignature;
+    for (int i = 0; i < signatures.size(); i++) {
+        cityBySignature[signatures[i]] = i;
+    }
+    if (cityBySignature.size() != signatures.size()) {
+        return false;
+    }
+
+    string line;
+    while (getline(index, line)) {
+        stringstream stream(line);
+        string hex;
+        stream >> hex;
+        uint64_t key = std::stoull(hex, nullptr, 16);
+
+        // order[k] is the city of the submitted problem playing the role of the stored city k
+        vector<int> order;
+        while (stream >> hex) {
+            std::map<uint64_t, int>::iterator it = cityBySignature.find(std::stoull(hex, nullptr, 16));
+            if (it == cityBySignature.end()) {
+                break;
+            }
+            order.push_back(it->second);
+        }
+        if (order.size() != signatures.size() or matrixHash(m, order) != key or !readEntry(key, order.size(), entry)) {
+            continue;
+        }
+
+        for (int &city : entry.tour) {
+            city = order[city - 1] + 1;
+        }
+        std::rotate(entry.tour.begin(), std::find(entry.tour.begin(), entry.tour.end(), 1), entry.tour.end());
+        if (isValid(m, entry)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Return the stored tour of the problem, false if it has never been solved or the stored tour does not fit it
+bool ResultCache::lookup(Matrix<int> &m, CacheEntry &entry) {
+    vector<int> order(m.getNbRows());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::lock_guard<std::mutex> lock(this->fileMutex);
+    if (readEntry(matrixHash(m, order), order.size(), entry) and isValid(m, entry)) {
+        return true;
+    }
+    return this->detectRelabel and findRelabelled(m, entry);
+}
+
+// Store the tour of a problem, unless a better or proven one is already stored
+void ResultCache::store(Matrix<int> &m, const CacheEntry &entry) {
+    if (entry.tour.empty()) {
+        return;
+    }
+
+    vector<int> order(m.getNbRows());
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    uint64_t key = matrixHash(m, order);
+
+    std::lock_guard<std::mutex> lock(this->fileMutex);
+    CacheEntry stored;
+    bool known = readEntry(key, order.size(), stored);
+    if (known and isValid(m, stored) and (stored.optimal or (stored.cost <= entry.cost and !entry.optimal))) {
+        return;
+    }
+
+    // Written aside then renamed, so that a concurrent reader never sees a partial file
+    string path = tourPath(key);
+    string temporaryPath = path + ".tmp";
+    ofstream file(temporaryPath);
+    if (!file) {
+        return;
+    }
+    file << "NAME : " << toHex(key) << ".tour" << endl;
+    file << "COMMENT : Length = " << entry.cost << " " << (entry.optimal ? "OPTIMAL" : "FEASIBLE") << endl;
+    file << "TYPE : TOUR" << endl;
+    file << "DIMENSION : " << entry.tour.size() << endl;
+    file << "TOUR_SECTION" << endl;
+    for (int city : entry.tour) {
+        file << city << endl;
+    }
+    file << "-1" << endl;
+    file << "EOF" << endl;
+    file.close();
+    std::rename(temporaryPath.c_str(), path.c_str());
+
+    if (!known) {
+        vector<uint64_t> signatures = citySignatures(m);
+        ofstream index(indexPath(invariantHash(signatures)), std::ios::app);
+        index << toHex(key);
+        for (uint64_t signature : signatures) {
+            index << " " << toHex(signature);
+        }
+        index << endl;
+    }
+}
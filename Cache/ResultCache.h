@@ -0,0 +1,49 @@
+#ifndef RESULTCACHE_H
+#define	RESULTCACHE_H
+
+#include "../Matrix/Matrix.h"
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+using std::string;
+
+// Tour stored for a problem
+struct CacheEntry {
+    bool optimal;           // proven optimal or only the best tour found before the search stopped
+    int cost;
+    vector<int> tour;       // cities numbered from 1
+
+    CacheEntry(bool optimal = false, int cost = 0, vector<int> tour = vector<int>())
+            : optimal(optimal), cost(cost), tour(tour) {}
+};
+
+/*
+ * On-disk cache of the solved problems, keyed by a hash of their cost matrix.
+ * Each problem is stored as <directory>/<hash>.tour, and indexed in
+ * <directory>/<invariant>.index by a hash that does not depend on the city
+ * numbering, so that relabelled copies of a problem can be recognized
+ */
+class ResultCache {
+private:
+    string directory;
+    bool detectRelabel;     // look for relabelled copies on a miss or not
+    std::mutex fileMutex;
+
+    static uint64_t matrixHash(Matrix<int> &m, const vector<int> &order);
+    static vector<uint64_t> citySignatures(Matrix<int> &m);
+    static uint64_t invariantHash(vector<uint64_t> signatures);
+    static string toHex(uint64_t value);
+    string tourPath(uint64_t key) { return this->directory + "/" + toHex(key) + ".tour"; }
+    string indexPath(uint64_t key) { return this->directory + "/" + toHex(key) + ".index"; }
+    bool readEntry(uint64_t key, int nbCities, CacheEntry &entry);
+    bool findRelabelled(Matrix<int> &m, CacheEntry &entry);
+    static bool isValid(Matrix<int> &m, const CacheEntry &entry);
+
+public:
+    ResultCache(string directory, bool detectRelabel = false);
+    bool lookup(Matrix<int> &m, CacheEntry &entry);
+    void store(Matrix<int> &m, const CacheEntry &entry);
+};
+
+#endif	/* RESULTCACHE_H */
@@ -0,0 +1,333 @@
+#include "Coordinator.h"
+#include "../Server/Server.h"
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+using std::cout;
+using std::endl;
+using std::istringstream;
+using std::ostringstream;
+
+Coordinator::Coordinator(const Matrix<int> &matrix, int port, int splitDepth, string bound, string rule, int nbCandidates)
+        : port(port), matrix(matrix), splitDepth(splitDepth), bound(bound), rule(rule), nbCandidates(nbCandidates) {
+}
+
+/*
+ * Split the problem and solve the subproblems on the connected workers,
+ * starting from the initial tour if any. Return false on error
+ */
+bool Coordinator::run(const vector<int> &initialTour) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cout << "Error : Socket cannot be created" << endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(this->port);
+    if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 or ::listen(listener, 64) < 0) {
+        cout << "Error : Port " << this->port << " cannot be bound" << endl;
+        close(listener);
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // Subproblems of the tree split at the chosen depth
+    Little<int> little(this->matrix);
+    little.setVerbose(false);
+    little.setBranchingRule(makeBranchingRule<int>(this->rule, this->nbCandidates));
+    little.setAssignmentBound(this->bound == "ap");
+    little.setSymmetric(true);      // the subproblems without included segment exclude the reverse of the tours if the costs are symmetric
+    if (!initialTour.empty() and little.setInitialTour(initialTour)) {
+        this->tour = little.getLastTour();
+        this->cost = little.getCost();
+    }
+    for (const Subproblem<int> &subproblem : little.split(this->splitDepth)) {
+        this->pending.insert(std::make_pair(subproblem.bound, subproblem));
+    }
+    cout << "Listening on port " << this->port << ", " << this->pending.size() << " subproblems" << endl;
+
+    std::thread acceptThread(&Coordinator::acceptWorkers, this, listener);
+    int nbWorkers = 0;
+    while (true) {
+        bool busy = false;
+        for (const pair<const int, RemoteWorker> &worker : this->workers) {
+            busy = busy or worker.second.busy;
+        }
+        if (!busy and this->pending.empty()) {
+            break;
+        }
+
+        WorkerEvent event;
+        {
+            std::unique_lock<std::mutex> lock(this->eventsMutex);
+            // Timeout so that the workers which refused a steal get asked again
+            this->eventsCondition.wait_for(lock, std::chrono::milliseconds(50), [this]() { return !this->events.empty(); });
+            if (this->events.empty()) {
+                dispatch();
+                continue;
+            }
+            event = this->events.front();
+            this->events.pop_front();
+        }
+        if (event.connection) {
+            nbWorkers++;
+        }
+        handle(event);
+        dispatch();
+    }
+    // A task left unfinished by its worker may hide a better tour
+    this->optimal = (this->nbStopped == 0);
+
+    // Shutting the connections down ends their reader threads
+    broadcast("END", -1);
+    ::shutdown(listener, SHUT_RDWR);
+    acceptThread.join();
+    close(listener);
+    for (shared_ptr<Connection> &connection : this->connections) {
+        connection->shutdown();
+    }
+    for (std::thread &thread : this->threads) {
+        thread.join();
+    }
+
+#ifdef DEBUG
+    cout << nbWorkers << " workers, " << this->nbTasks << " subproblems solved, " << this->nbStopped << " stopped, " << this->nbStolen
+         << " given by busy workers, " << this->nbNodes << " nodes" << endl;
+#endif
+    return true;
+}
+
+// Accept the workers until the listener is shut down
+void Coordinator::acceptWorkers(int listener) {
+    int nbWorkers = 0;
+    while (true) {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        WorkerEvent event;
+        event.worker = ++nbWorkers;
+        event.connection = std::make_shared<Connection>(client);
+        {
+            std::lock_guard<std::mutex> lock(this->threadsMutex);
+            this->threads.push_back(std::thread(&Coordinator::readWorker, this, event.worker, event.connection));
+            this->connections.push_back(event.connection);
+        }
+        pushEvent(event);
+    }
+}
+
+// Queue the messages of a worker for the coordinator, until it is gone
+void Coordinator::readWorker(int worker, shared_ptr<Connection> connection) {
+    WorkerEvent event;
+    event.worker = worker;
+    while (connection->readLine(event.line)) {
+        pushEvent(event);
+    }
+    event.closed = true;
+    pushEvent(event);
+}
+
+void Coordinator::pushEvent(const WorkerEvent &event) {
+    std::lock_guard<std::mutex> lock(this->eventsMutex);
+    this->events.push_back(event);
+    this->eventsCondition.notify_one();
+}
+
+// Update the search with a worker event
+void Coordinator::handle(const WorkerEvent &event) {
+    if (event.connection) {
+        RemoteWorker worker;
+        worker.connection = event.connection;
+        this->workers[event.worker] = worker;
+
+        int size = this->matrix.getNbRows();
+        ostringstream problem;
+        problem << "PROBLEM " << size << " " << this->matrix.getEmptyValue() << " " << this->bound << " "
+                << this->rule << " " << this->nbCandidates << " " << this->kernelSize << " " << this->transpositionTableSize;
+        for (int i = 0; i < size; i++) {
+            problem << "\n";
+            for (int j = 0; j < size; j++) {
+                problem << (j > 0 ? " " : "") << this->matrix.getValue(i, j);
+            }
+        }
+        event.connection->send(problem.str());
+        if (!this->tour.empty()) {
+            event.connection->send("BOUND " + std::to_string(this->cost));
+        }
+        return;
+    }
+
+    map<int, RemoteWorker>::iterator found = this->workers.find(event.worker);
+    if (found == this->workers.end()) {
+        return;
+    }
+    RemoteWorker &worker = found->second;
+    if (event.closed) {
+        if (worker.busy) {
+            // The task of a lost worker is handed out again
+            this->pending.insert(std::make_pair(worker.subproblem.bound, worker.subproblem));
+        }
+        this->workers.erase(found);
+        return;
+    }
+
+    istringstream message(event.line);
+    string command;
+    message >> command;
+    if (command == "TOUR") {
+        int tourCost;
+        vector<int> received;
+        int city;
+        message >> tourCost;
+        while (message >> city) {
+            received.push_back(city);
+        }
+
+        // Check that it is a tour of the problem, of the announced cost
+        int size = this->matrix.getNbRows();
+        vector<bool> visited(size + 1, false);
+        bool valid = received.size() == size;
+        long total = 0;
+        for (int i = 0; valid and i < size; i++) {
+            valid = received[i] >= 1 and received[i] <= size and !visited[received[i]];
+            if (valid) {
+                visited[received[i]] = true;
+                total += this->matrix.getValue(received[i] - 1, received[(i + 1) % size] - 1);
+            }
+        }
+        if (valid and total == tourCost and (this->tour.empty() or tourCost < this->cost)) {
+            this->tour = received;
+            this->cost = tourCost;
+            broadcast("BOUND " + std::to_string(this->cost), event.worker);
+        }
+    }
+    else if (command == "GIVE") {
+        worker.stealing = false;
+        Subproblem<int> subproblem;
+        if (readSubproblem(message, subproblem)) {
+            this->pending.insert(std::make_pair(subproblem.bound, subproblem));
+            this->nbStolen++;
+        }
+        else {
+            worker.refused = std::chrono::steady_clock::now();
+        }
+    }
+    else if (command == "DONE") {
+        int task;
+        long nodes;
+        string status;
+        if (message >> task >> nodes >> status and worker.busy and task == worker.task) {
+            worker.busy = false;
+            this->nbNodes += nodes;
+            this->nbStopped += (status != "completed");
+        }
+    }
+}
+
+/*
+ * Hand out the pending subproblems to the idle workers, then ask the busy
+ * workers for open nodes while some workers stay idle
+ */
+void Coordinator::dispatch() {
+    // Subproblems which cannot improve the best tour
+    while (!this->pending.empty() and !this->tour.empty() and this->pending.rbegin()->first >= this->cost) {
+        this->pending.erase(std::prev(this->pending.end()));
+    }
+
+    int nbIdle = 0;
+    int nbStealing = 0;
+    for (pair<const int, RemoteWorker> &entry : this->workers) {
+        RemoteWorker &worker = entry.second;
+        nbStealing += worker.stealing;
+        if (worker.busy) {
+            continue;
+        }
+        if (this->pending.empty()) {
+            nbIdle++;
+            continue;
+        }
+        worker.busy = true;
+        worker.task = ++this->nbTasks;
+        worker.subproblem = this->pending.begin()->second;
+        this->pending.erase(this->pending.begin());
+        worker.connection->send("TASK " + std::to_string(worker.task) + " " + writeSubproblem(worker.subproblem));
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (pair<const int, RemoteWorker> &entry : this->workers) {
+        RemoteWorker &worker = entry.second;
+        if (nbStealing >= nbIdle) {
+            break;
+        }
+        if (worker.busy and !worker.stealing and now - worker.refused >= std::chrono::milliseconds(50)) {
+            worker.connection->send("STEAL");
+            worker.stealing = true;
+            nbStealing++;
+        }
+    }
+}
+
+// Send a message to all the workers but one
+void Coordinator::broadcast(const string &message, int except) {
+    for (pair<const int, RemoteWorker> &worker : this->workers) {
+        if (worker.first != except) {
+            worker.second.connection->send(message);
+        }
+    }
+}
+
+// Return the text of a subproblem
+string writeSubproblem(const Subproblem<int> &subproblem) {
+    ostringstream text;
+    text << subproblem.bound << " " << subproblem.included.size();
+    for (const pair<int, int> &segment : subproblem.included) {
+        text << " " << segment.first << " " << segment.second;
+    }
+    text << " " << subproblem.excluded.size();
+    for (const pair<int, int> &segment : subproblem.excluded) {
+        text << " " << segment.first << " " << segment.second;
+    }
+    return text.str();
+}
+
+// Read the text of a subproblem, return false on error
+bool readSubproblem(std::istream &stream, Subproblem<int> &subproblem) {
+    int nbIncluded, nbExcluded;
+    pair<int, int> segment;
+    if (!(stream >> subproblem.bound >> nbIncluded) or nbIncluded < 0) {
+        return false;
+    }
+    subproblem.included.clear();
+    for (int i = 0; i < nbIncluded; i++) {
+        if (!(stream >> segment.first >> segment.second)) {
+            return false;
+        }
+        subproblem.included.push_back(segment);
+    }
+    if (!(stream >> nbExcluded) or nbExcluded < 0) {
+        return false;
+    }
+    subproblem.excluded.clear();
+    for (int i = 0; i < nbExcluded; i++) {
+        if (!(stream >> segment.first >> segment.second)) {
+            return false;
+        }
+        subproblem.excluded.push_back(segment);
+    }
+    return true;
+}
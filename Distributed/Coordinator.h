@@ -0,0 +1,112 @@
+#ifndef COORDINATOR_H
+#define	COORDINATOR_H
+
+#include "../Matrix/Matrix.h"
+#include "../Little/Little.h"
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+
+using std::string;
+using std::map;
+using std::deque;
+using std::shared_ptr;
+
+class Connection;
+
+/*
+ * Search of one problem spread over worker processes, connected by TCP.
+ * The tree is split at a given depth into subproblems, handed out to the
+ * idle workers. Once they are all handed out, the idle workers get the
+ * open nodes nearest from the root of the busy workers.
+ *
+ * Messages to the workers (one per line, cities are numbered from 1) :
+ *   PROBLEM <n> <infinity> <reduction|ap> <rule> <candidates> <kernel size> <table bytes>
+ *                                       followed by n lines of n costs, kernel size -1 for the
+ *                                       default and table bytes 0 for no transposition table
+ *   TASK <task> <subproblem>
+ *   BOUND <cost>                        cost of the best tour found so far
+ *   STEAL                               request for an open node
+ *   END
+ *
+ * Messages from the workers :
+ *   TOUR <cost> <city> ...              each time a better tour is found
+ *   GIVE <subproblem> | GIVE NONE       reply to STEAL
+ *   DONE <task> <nodes> <completed|stopped>   stopped if the task was invalid or its search interrupted
+ *
+ * A subproblem is written as its bound, then the number of included
+ * segments and their cities, then the same for the excluded segments
+ */
+
+// Worker process as seen by the coordinator
+struct RemoteWorker {
+    shared_ptr<Connection> connection;
+    bool busy = false;
+    int task = 0;                           // task being solved
+    Subproblem<int> subproblem;             // its constraints, handed out again if the worker is lost
+    bool stealing = false;                  // STEAL sent, waiting for the reply
+    std::chrono::steady_clock::time_point refused;  // last GIVE NONE
+};
+
+// Message of a worker, or its connection or disconnection
+struct WorkerEvent {
+    int worker;
+    string line;
+    shared_ptr<Connection> connection;      // new worker, when connected
+    bool closed = false;
+};
+
+class Coordinator {
+private:
+    int port;
+    Matrix<int> matrix;                     // problem, without the indexes
+    int splitDepth;
+    string bound;                           // reduction or ap
+    string rule;                            // branching rule name
+    int nbCandidates;
+    int kernelSize = -1;                    // largest subproblem searched by the kernels, -1 for the default
+    size_t transpositionTableSize = 0;      // bytes of the transposition table of each worker, 0 for none
+    vector<int> tour;                       // best tour found
+    int cost = 0;
+    bool optimal = false;
+    int nbStopped = 0;                      // tasks whose search did not complete
+
+    std::mutex eventsMutex;
+    std::condition_variable eventsCondition;
+    deque<WorkerEvent> events;
+    map<int, RemoteWorker> workers;
+    std::mutex threadsMutex;
+    vector<std::thread> threads;            // reader thread of each worker
+    vector<shared_ptr<Connection> > connections;    // each accepted worker, even those not handled yet
+
+    std::multimap<int, Subproblem<int> > pending;   // subproblems waiting for a worker, by bound
+    int nbTasks = 0;
+    int nbStolen = 0;
+    long nbNodes = 0;
+
+    void acceptWorkers(int listener);
+    void readWorker(int worker, shared_ptr<Connection> connection);
+    void pushEvent(const WorkerEvent &event);
+    void handle(const WorkerEvent &event);
+    void dispatch();
+    void broadcast(const string &message, int except);
+
+public:
+    Coordinator(const Matrix<int> &matrix, int port, int splitDepth, string bound, string rule, int nbCandidates);
+    void setKernelSize(int kernelSize) { this->kernelSize = kernelSize; }
+    void setTranspositionTableSize(size_t size) { this->transpositionTableSize = size; }
+    bool run(const vector<int> &initialTour);
+    vector<int> getTour() { return this->tour; }        // Return the best tour found
+    int getCost() { return this->cost; }                // Return its cost
+    bool isOptimal() { return this->optimal; }          // Return whether the tour is proven optimal
+};
+
+string writeSubproblem(const Subproblem<int> &subproblem);
+bool readSubproblem(std::istream &stream, Subproblem<int> &subproblem);
+
+#endif	/* COORDINATOR_H */
@@ -0,0 +1,211 @@
+#include "Worker.h"
+#include "Coordinator.h"
+#include "../Server/Server.h"
+#include "../Little/Little.h"
+#include <sstream>
+#include <thread>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+using std::cout;
+using std::endl;
+using std::istringstream;
+using std::ostringstream;
+
+// Connect to the coordinator and solve its tasks until it ends, return false on error
+bool Worker::run() {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses;
+    if (getaddrinfo(this->host.c_str(), std::to_string(this->port).c_str(), &hints, &addresses) != 0) {
+        cout << "Error : Unknown host " << this->host << endl;
+        return false;
+    }
+    int fd = -1;
+    for (addrinfo *address = addresses; address != nullptr and fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd >= 0 and connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        cout << "Error : Coordinator " << this->host << ":" << this->port << " cannot be reached" << endl;
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    this->connection = std::make_shared<Connection>(fd);
+
+    if (!readProblem()) {
+        cout << "Error : No valid problem received from the coordinator" << endl;
+        return false;
+    }
+
+    std::thread reader(&Worker::readMessages, this);
+    while (true) {
+        string task;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [this]() { return this->ended or !this->tasks.empty(); });
+            if (this->ended) {
+                break;
+            }
+            task = this->tasks.front();
+            this->tasks.pop_front();
+            this->running = true;
+        }
+        solve(task);
+    }
+    this->connection->shutdown();
+    reader.join();
+    return true;
+}
+
+// Read the PROBLEM message, return false on error
+bool Worker::readProblem() {
+    string line;
+    if (!this->connection->readLine(line)) {
+        return false;
+    }
+    istringstream message(line);
+    string command;
+    int size, infinity;
+    size_t transpositionTableSize;
+    if (!(message >> command >> size >> infinity >> this->bound >> this->rule >> this->nbCandidates >> this->kernelSize >>
+                  transpositionTableSize) or
+            command != "PROBLEM" or size < 3 or !makeBranchingRule<int>(this->rule, this->nbCandidates)) {
+        return false;
+    }
+    if (transpositionTableSize > 0) {
+        this->transpositionTable = std::make_shared<TranspositionTable<int> >(transpositionTableSize);
+    }
+
+    this->matrix = Matrix<int>(size, size, infinity);
+    for (int i = 0; i < size; i++) {
+        if (!this->connection->readLine(line)) {
+            return false;
+        }
+        istringstream row(line);
+        for (int j = 0; j < size; j++) {
+            int value;
+            if (!(row >> value)) {
+                return false;
+            }
+            this->matrix.setValue(i, j, value);
+        }
+    }
+    return true;
+}
+
+// Reader thread, handle the messages of the coordinator
+void Worker::readMessages() {
+    string line;
+    while (this->connection->readLine(line)) {
+        istringstream message(line);
+        string command;
+        message >> command;
+        if (command == "TASK") {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->tasks.push_back(line);
+            this->condition.notify_one();
+        }
+        else if (command == "BOUND") {
+            int cost;
+            if (message >> cost) {
+                lowerIncumbent(cost);
+            }
+        }
+        else if (command == "STEAL") {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->running) {
+                this->stealRequested = true;    // answered by the search, or once it ends
+            }
+            else {
+                this->connection->send("GIVE NONE");
+            }
+        }
+        else if (command == "END") {
+            break;
+        }
+    }
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->ended = true;
+    this->condition.notify_one();
+}
+
+// Solve a TASK message, sending the improved tours and the open nodes asked for
+void Worker::solve(const string &task) {
+    istringstream message(task);
+    string command;
+    int id;
+    Subproblem<int> subproblem;
+    message >> command >> id;
+
+    Little<int> little(this->matrix);
+    little.setVerbose(false);
+    little.setBranchingRule(makeBranchingRule<int>(this->rule, this->nbCandidates));
+    little.setAssignmentBound(this->bound == "ap");
+    little.setSymmetric(true);      // kept asymmetric unless the costs are symmetric
+    little.setMemoryLimit(this->memoryLimit);
+    if (this->kernelSize >= 0) {
+        little.setKernelSize(this->kernelSize);
+    }
+    if (this->transpositionTable) {
+        little.setTranspositionTable(this->transpositionTable);
+    }
+    long nbNodes = 0;
+    bool completed = false;
+    if (readSubproblem(message, subproblem) and little.setConstraints(subproblem)) {
+        little.setSharedBound([this]() { return this->incumbent.load(); });
+        little.setTourCallback([this](int cost, const vector<int> &tour) {
+            lowerIncumbent(cost);
+            ostringstream reply;
+            reply << "TOUR " << cost;
+            for (int city : tour) {
+                reply << " " << city;
+            }
+            this->connection->send(reply.str());
+        });
+        little.setWorkSharing([this]() {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            bool requested = this->stealRequested;
+            this->stealRequested = false;
+            return requested;
+        }, [this](const Subproblem<int> &open) {
+            this->connection->send("GIVE " + writeSubproblem(open));
+        });
+        little.setStopCondition([this]() { return this->ended.load(); });
+        little.findTour();
+        if (little.hasSpillFailed()) {
+            cout << "Error : Spill file cannot be written or read, the task is incomplete" << endl;
+        }
+        nbNodes = little.getNbNodes();
+        completed = !little.isStopped();
+    }
+    else {
+        cout << "Error : Invalid task " << task << endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->running = false;
+        if (this->stealRequested) {
+            this->stealRequested = false;
+            this->connection->send("GIVE NONE");
+        }
+    }
+    this->connection->send("DONE " + std::to_string(id) + " " + std::to_string(nbNodes) + (completed ? " completed" : " stopped"));
+}
+
+// Keep the smallest known tour cost
+void Worker::lowerIncumbent(int cost) {
+    int current = this->incumbent.load();
+    while (cost < current and !this->incumbent.compare_exchange_weak(current, cost)) {
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef WORKER_H
+#define	WORKER_H
+
+#include "../Matrix/Matrix.h"
+#include "../Little/Little.h"
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <limits>
+
+using std::string;
+using std::deque;
+using std::shared_ptr;
+
+class Connection;
+
+/*
+ * Process solving the subproblems handed out by a coordinator, see
+ * Coordinator.h for the messages. It gives the open node nearest from the
+ * root of its search when the coordinator asks for one
+ */
+class Worker {
+private:
+    string host;
+    int port;
+    size_t memoryLimit = 0;                 // bytes of open nodes kept in memory by the search, 0 for no limit
+    shared_ptr<Connection> connection;
+    Matrix<int> matrix;                     // problem, without the indexes
+    string bound;                           // reduction or ap
+    string rule;                            // branching rule name
+    int nbCandidates = 5;
+    int kernelSize = -1;                    // largest subproblem searched by the kernels, -1 for the default
+    shared_ptr<TranspositionTable<int> > transpositionTable;   // shared by the tasks, if any
+    std::atomic<int> incumbent;             // cost of the best tour found by any worker
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    deque<string> tasks;                    // TASK messages waiting to be solved
+    std::atomic<bool> ended;                // END received or coordinator gone
+    bool running = false;                   // task being solved
+    bool stealRequested = false;            // STEAL received during the task
+
+    bool readProblem();
+    void readMessages();
+    void solve(const string &task);
+    void lowerIncumbent(int cost);
+
+public:
+    Worker(string host, int port) : host(host), port(port), incumbent(std::numeric_limits<int>::max()), ended(false) {}
+    void setMemoryLimit(size_t memoryLimit) { this->memoryLimit = memoryLimit; }
+    bool run();
+};
+
+#endif	/* WORKER_H */
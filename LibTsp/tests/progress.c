@@ -0,0 +1,79 @@
+/*
+ * Solve through the C interface with a progress callback : each reported
+ * tour must be a tour of the problem, of decreasing cost, the last one
+ * being the returned optimal tour. A callback returning non-zero stops
+ * the search
+ */
+
+#include "tsp.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 12
+
+static int costs[N * N];
+
+struct progress {
+    int nbCalls;
+    long long lastCost;
+    int stopAfter;      /* calls before stopping the search, 0 to never stop */
+    int failed;
+};
+
+static int onTour(void *user_data, long long cost, const int *tour, int n) {
+    struct progress *progress = (struct progress *) user_data;
+    int visited[N] = {0};
+    long long tourCost = 0;
+    int i;
+    if (n != N) {
+        progress->failed = 1;
+        return 1;
+    }
+    for (i = 0; i < n; i++) {
+        if (tour[i] < 0 || tour[i] >= N || visited[tour[i]]) {
+            progress->failed = 1;
+            return 1;
+        }
+        visited[tour[i]] = 1;
+        tourCost += costs[tour[i] * N + tour[(i + 1) % n]];
+    }
+    if (tourCost != cost || (progress->nbCalls > 0 && cost >= progress->lastCost)) {
+        progress->failed = 1;
+    }
+    progress->nbCalls++;
+    progress->lastCost = cost;
+    return progress->stopAfter > 0 && progress->nbCalls >= progress->stopAfter;
+}
+
+int main(void) {
+    struct progress progress = {0, 0, 0, 0};
+    tsp_options *options = tsp_options_create();
+    int tour[N];
+    long long cost;
+    int i, j, status;
+
+    srand(1);
+    for (i = 0; i < N; i++) {
+        for (j = 0; j < N; j++) {
+            costs[i * N + j] = (i == j) ? 0 : 1 + rand() % 100;
+        }
+    }
+    tsp_options_set_progress(options, onTour, &progress);
+
+    status = tsp_solve(costs, N, 999999999, options, tour, &cost);
+    if (status != TSP_OPTIMAL || progress.failed || progress.nbCalls == 0 || progress.lastCost != cost) {
+        printf("Error : solve with progress returned %d after %d calls\n", status, progress.nbCalls);
+        return 1;
+    }
+
+    progress.nbCalls = 0;
+    progress.stopAfter = 1;
+    status = tsp_solve(costs, N, 999999999, options, tour, &cost);
+    if (status != TSP_STOPPED || progress.failed || progress.nbCalls != 1) {
+        printf("Error : solve stopped by the progress callback returned %d after %d calls\n", status, progress.nbCalls);
+        return 1;
+    }
+
+    tsp_options_destroy(options);
+    return 0;
+}
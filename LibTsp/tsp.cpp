@@ -0,0 +1,141 @@
+#include "tsp.h"
+#include "../Little/Little.h"
+#include <chrono>
+#include <exception>
+
+struct tsp_options {
+    long long nodeLimit = 0;
+    double timeLimit = 0;
+    vector<int> initialTour;            // cities numbered from 0
+    int branchingRule = TSP_BRANCH_REGRET;
+    int nbCandidates = 5;
+    int bound = TSP_BOUND_REDUCTION;
+    long long memoryLimit = 0;
+    long long ttSize = 0;
+    tsp_progress_callback progress = nullptr;
+    void *userData = nullptr;
+};
+
+tsp_options *tsp_options_create(void) {
+    try {
+        return new tsp_options();
+    }
+    catch (const std::exception &e) {
+        return nullptr;
+    }
+}
+
+void tsp_options_destroy(tsp_options *options) {
+    delete options;
+}
+
+void tsp_options_set_node_limit(tsp_options *options, long long node_limit) {
+    options->nodeLimit = node_limit;
+}
+
+void tsp_options_set_time_limit(tsp_options *options, double seconds) {
+    options->timeLimit = seconds;
+}
+
+void tsp_options_set_initial_tour(tsp_options *options, const int *tour, int n) {
+    options->initialTour.assign(tour, tour + n);
+}
+
+void tsp_options_set_branching(tsp_options *options, int rule, int candidates) {
+    options->branchingRule = rule;
+    options->nbCandidates = candidates;
+}
+
+void tsp_options_set_bound(tsp_options *options, int bound) {
+    options->bound = bound;
+}
+
+void tsp_options_set_memory_limit(tsp_options *options, long long bytes) {
+    options->memoryLimit = bytes;
+}
+
+void tsp_options_set_tt_size(tsp_options *options, long long bytes) {
+    options->ttSize = bytes;
+}
+
+void tsp_options_set_progress(tsp_options *options, tsp_progress_callback callback, void *user_data) {
+    options->progress = callback;
+    options->userData = user_data;
+}
+
+int tsp_solve(const int *costs, int n, int infinity, const tsp_options *options, int *tour, long long *cost) {
+    if (costs == nullptr or n < 3 or tour == nullptr or cost == nullptr) {
+        return TSP_INVALID_ARGUMENT;
+    }
+    tsp_options defaults;
+    if (options == nullptr) {
+        options = &defaults;
+    }
+
+    try {
+        Little<int> little(costs, n, infinity);
+        little.setVerbose(false);
+
+        const char *rules[] = {"regret", "tie", "strong", "subtour"};
+        if (options->branchingRule < TSP_BRANCH_REGRET or options->branchingRule > TSP_BRANCH_SUBTOUR or
+                options->bound < TSP_BOUND_REDUCTION or options->bound > TSP_BOUND_ASSIGNMENT) {
+            return TSP_INVALID_ARGUMENT;
+        }
+        little.setBranchingRule(makeBranchingRule<int>(rules[options->branchingRule], options->nbCandidates));
+        little.setAssignmentBound(options->bound == TSP_BOUND_ASSIGNMENT);
+        little.setSymmetric(true);      // kept asymmetric unless the costs are symmetric
+        if (options->memoryLimit > 0) {
+            little.setMemoryLimit(options->memoryLimit);
+        }
+        if (options->ttSize > 0) {
+            little.setTranspositionTable(std::make_shared<TranspositionTable<int> >(options->ttSize));
+        }
+
+        // The library numbers the cities from 0, Little from 1
+        if (!options->initialTour.empty()) {
+            vector<int> initialTour(options->initialTour);
+            for (int &city : initialTour) {
+                city++;
+            }
+            if (!little.setInitialTour(initialTour)) {
+                return TSP_INVALID_ARGUMENT;
+            }
+        }
+
+        // Kept for the whole search, the callback is called by findTour
+        bool callbackStop = false;
+        vector<int> reported(n);
+        if (options->progress) {
+            little.setTourCallback([options, &reported, &callbackStop](int tourCost, const vector<int> &found) {
+                for (int i = 0; i < found.size(); i++) {
+                    reported[i] = found[i] - 1;
+                }
+                if (options->progress(options->userData, tourCost, reported.data(), reported.size()) != 0) {
+                    callbackStop = true;
+                }
+            });
+        }
+
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options->timeLimit));
+        little.setStopCondition([options, &little, &callbackStop, deadline]() {
+            return callbackStop or
+                   (options->nodeLimit > 0 and little.getNbNodes() >= options->nodeLimit) or
+                   (options->timeLimit > 0 and std::chrono::steady_clock::now() >= deadline);
+        });
+        little.findTour();
+
+        vector<int> found = little.getLastTour();
+        if (found.empty()) {
+            return little.isStopped() ? TSP_NO_TOUR : TSP_INFEASIBLE;
+        }
+        for (int i = 0; i < n; i++) {
+            tour[i] = found[i] - 1;
+        }
+        *cost = little.getCost();
+        return little.isOptimal() ? TSP_OPTIMAL : TSP_STOPPED;
+    }
+    catch (const std::exception &e) {
+        return TSP_ERROR;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef TSP_H
+#define	TSP_H
+
+/*
+ * C interface of the Little solver.
+ *
+ * Costs are given as a row-major buffer of n * n ints, which is neither
+ * kept nor modified : it is copied once into the indexed matrix of the
+ * solver. The diagonal is ignored and the cost equal to the submitted
+ * infinity marks a missing segment. Cities are numbered from 0.
+ * The options are opaque so that new ones can be added without breaking
+ * the binary interface.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TSP_OPTIMAL 0           /* the tour is proven optimal */
+#define TSP_STOPPED 1           /* the search has been stopped, the tour is the best one found */
+#define TSP_NO_TOUR 2           /* the search has been stopped before finding any tour */
+#define TSP_INFEASIBLE 3        /* the search has completed without any tour, each one needs a missing segment */
+#define TSP_INVALID_ARGUMENT -1
+#define TSP_ERROR -2            /* internal error, such as a memory exhaustion */
+
+#define TSP_BRANCH_REGRET 0     /* maximal regret, first cell found on ties */
+#define TSP_BRANCH_TIE 1        /* maximal regret, deterministic tie-breaking */
+#define TSP_BRANCH_STRONG 2     /* strong branching among the largest regrets */
+#define TSP_BRANCH_SUBTOUR 3    /* shortest subtour of the assignment, with TSP_BOUND_ASSIGNMENT */
+
+#define TSP_BOUND_REDUCTION 0   /* rows and columns reduction */
+#define TSP_BOUND_ASSIGNMENT 1  /* assignment problem, tighter on asymmetric problems */
+
+typedef struct tsp_options tsp_options;
+
+/*
+ * Called on each improved tour, of n cities, the search stops
+ * when it returns a non-zero value
+ */
+typedef int (*tsp_progress_callback)(void *user_data, long long cost, const int *tour, int n);
+
+tsp_options *tsp_options_create(void);
+void tsp_options_destroy(tsp_options *options);
+void tsp_options_set_node_limit(tsp_options *options, long long node_limit);     /* 0 for no limit */
+void tsp_options_set_time_limit(tsp_options *options, double seconds);          /* 0 for no limit */
+void tsp_options_set_initial_tour(tsp_options *options, const int *tour, int n);
+void tsp_options_set_branching(tsp_options *options, int rule, int candidates);  /* candidates of TSP_BRANCH_STRONG */
+void tsp_options_set_bound(tsp_options *options, int bound);
+void tsp_options_set_memory_limit(tsp_options *options, long long bytes);       /* 0 for no limit, open nodes beyond are spilled to a temporary file */
+void tsp_options_set_tt_size(tsp_options *options, long long bytes);            /* 0 for none, table pruning the subproblems reached again */
+void tsp_options_set_progress(tsp_options *options, tsp_progress_callback callback, void *user_data);
+
+/*
+ * Solve the problem, options may be NULL. On TSP_OPTIMAL and TSP_STOPPED
+ * the n cities of the tour are written in tour and its cost in cost
+ */
+int tsp_solve(const int *costs, int n, int infinity, const tsp_options *options, int *tour, long long *cost);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* TSP_H */
@@ -0,0 +1,300 @@
+#ifndef BRANCHINGRULE_H
+#define BRANCHINGRULE_H
+
+// Included by Little.h, the rules use the reduction helpers of the Little class
+
+#include <string>
+#include <memory>
+
+using std::string;
+
+template<class T> class Little;
+
+/*
+ * Choice of the segment to branch on : the zero cell of the reduced matrix
+ * that is either included in the tour or excluded from it in the two children
+ */
+template<class T>
+class BranchingRule {
+protected:
+    T getInfinity(Little<T> &little) { return little.infinity; }
+    T getMinRow(Little<T> &little, Matrix<T> &m, int row, int ignoredCol) { return little.getMinRow(m, row, ignoredCol); }
+    T getMinCol(Little<T> &little, Matrix<T> &m, int col, int ignoredRow) { return little.getMinCol(m, col, ignoredRow); }
+    T reduceMatrix(Little<T> &little, Matrix<T> &m) { return little.reduceMatrix(m); }
+    void removeSubTour(Little<T> &little, Matrix<T> &m, int id, pair<int, int> &path) { little.removeSubTour(m, id, path); }
+    const vector<int> &getAssignment(Little<T> &little) { return little.assignment; }
+
+    // Return the segments included in the tour at the node id
+    vector<pair<int, int> > getIncludedPath(Little<T> &little, int id) {
+        vector<pair<int, int> > path;
+        while (id != 0) {
+            if (little.tree[id].bar == false) {
+                path.push_back(little.tree[id].path);
+            }
+            id = little.tree[id].parentNodeKey;
+        }
+        return path;
+    }
+
+public:
+    virtual ~BranchingRule() {}
+    virtual string getName() = 0;
+    // Return the position of the chosen cell in the matrix of the node id
+    virtual pair<int, int> select(Little<T> &little, Matrix<T> &m, int id) = 0;
+};
+
+// Maximal regret, the first cell found wins the ties
+template<class T>
+class RegretRule : public BranchingRule<T> {
+public:
+    string getName() { return "regret"; }
+    pair<int, int> select(Little<T> &little, Matrix<T> &m, int id);
+};
+
+/*
+ * Maximal regret, the ties are broken by the fewest zeros in the row and the
+ * column of the cell (the inclusion then raises the bound the most), then by
+ * the smallest cities, so that the choice does not depend on the matrix order
+ */
+template<class T>
+class TieBreakRegretRule : public BranchingRule<T> {
+public:
+    string getName() { return "tie"; }
+    pair<int, int> select(Little<T> &little, Matrix<T> &m, int id);
+};
+
+/*
+ * Strong branching : the cells with the largest regrets are candidates,
+ * both of their children are evaluated and the cell whose weakest child
+ * raises the bound the most is chosen. The children are evaluated by the
+ * reduction whatever the bound of the search : the include child is
+ * reduced, the bound raise of the exclude child is taken as the regret,
+ * ignoring the exclusion of the reverse segment of the symmetric problems
+ */
+template<class T>
+class StrongBranchingRule : public BranchingRule<T> {
+private:
+    int nbCandidates;
+
+public:
+    StrongBranchingRule(int nbCandidates = 5) : nbCandidates(nbCandidates > 0 ? nbCandidates : 1) {}
+    string getName() { return "strong"; }
+    pair<int, int> select(Little<T> &little, Matrix<T> &m, int id);
+};
+
+/*
+ * With the assignment bound : the assigned segments and the already included
+ * paths form subtours, the assigned segment with the maximal regret of the
+ * shortest subtour is chosen, so that the subtour is broken in the child
+ * excluding it. Maximal regret otherwise
+ */
+template<class T>
+class SubtourRule : public BranchingRule<T> {
+private:
+    RegretRule<T> regretRule;
+
+public:
+    string getName() { return "subtour"; }
+    pair<int, int> select(Little<T> &little, Matrix<T> &m, int id);
+};
+
+// Return the rule named regret, tie, strong or subtour, nullptr for an unknown name
+template<class T> std::shared_ptr<BranchingRule<T> > makeBranchingRule(const string &name, int nbCandidates = 5) {
+    if (name == "regret") {
+        return std::make_shared<RegretRule<T> >();
+    }
+    if (name == "tie") {
+        return std::make_shared<TieBreakRegretRule<T> >();
+    }
+    if (name == "strong") {
+        return std::make_shared<StrongBranchingRule<T> >(nbCandidates);
+    }
+    if (name == "subtour") {
+        return std::make_shared<SubtourRule<T> >();
+    }
+    return nullptr;
+}
+
+template<class T> pair<int, int> RegretRule<T>::select(Little<T> &little, Matrix<T> &m, int id) {
+    int size = m.getNbRows();
+    pair<int, int> pos(1, 1);
+    T max = 0;
+    bool found = false;
+    for (int i = 1; i < size; i++) {
+        for (int j = 1; j < size; j++) {
+            if (m.getValue(i, j) == 0) {
+                T val = this->getMinRow(little, m, i, j) + this->getMinCol(little, m, j, i);
+                if (!found or max < val) {
+                    max = val;
+                    pos.first = i;
+                    pos.second = j;
+                    found = true;
+                }
+            }
+        }
+    }
+    return pos;
+}
+
+template<class T> pair<int, int> TieBreakRegretRule<T>::select(Little<T> &little, Matrix<T> &m, int id) {
+    int size = m.getNbRows();
+
+    // Zeros of each row and column
+    vector<int> rowZeros(size, 0);
+    vector<int> colZeros(size, 0);
+    for (int i = 1; i < size; i++) {
+        for (int j = 1; j < size; j++) {
+            if (m.getValue(i, j) == 0) {
+                rowZeros[i]++;
+                colZeros[j]++;
+            }
+        }
+    }
+
+    pair<int, int> pos(1, 1);
+    T max = 0;
+    int minZeros = 0;
+    pair<int, int> minPath;
+    bool found = false;
+    for (int i = 1; i < size; i++) {
+        for (int j = 1; j < size; j++) {
+            if (m.getValue(i, j) != 0) {
+                continue;
+            }
+            T val = this->getMinRow(little, m, i, j) + this->getMinCol(little, m, j, i);
+            int zeros = rowZeros[i] + colZeros[j];
+            pair<int, int> path(m.getValue(i, 0), m.getValue(0, j));
+            if (!found or max < val or
+                    (max == val and (zeros < minZeros or (zeros == minZeros and path < minPath)))) {
+                max = val;
+                minZeros = zeros;
+                minPath = path;
+                pos.first = i;
+                pos.second = j;
+                found = true;
+            }
+        }
+    }
+    return pos;
+}
+
+template<class T> pair<int, int> StrongBranchingRule<T>::select(Little<T> &little, Matrix<T> &m, int id) {
+    int size = m.getNbRows();
+
+    // Candidates sorted by decreasing regret
+    vector<pair<T, pair<int, int> > > candidates;
+    for (int i = 1; i < size; i++) {
+        for (int j = 1; j < size; j++) {
+            if (m.getValue(i, j) == 0) {
+                T val = this->getMinRow(little, m, i, j) + this->getMinCol(little, m, j, i);
+                candidates.push_back(std::make_pair(val, std::make_pair(i, j)));
+            }
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const pair<T, pair<int, int> > &a, const pair<T, pair<int, int> > &b) { return a.first > b.first; });
+    if (candidates.size() > (size_t) this->nbCandidates) {
+        candidates.resize(this->nbCandidates);
+    }
+
+    pair<int, int> pos(1, 1);
+    T bestWeakest = 0;
+    T bestSum = 0;
+    bool found = false;
+    for (const pair<T, pair<int, int> > &candidate : candidates) {
+        int i = candidate.second.first;
+        int j = candidate.second.second;
+
+        // Bound raise of the child including the segment
+        Matrix<T> included = m;
+        pair<int, int> path(m.getValue(i, 0), m.getValue(0, j));
+        included.removeRow(i);
+        included.removeColumn(j);
+        this->removeSubTour(little, included, id, path);
+        T includeRaise = this->reduceMatrix(little, included);
+
+        // Bound raise of the child excluding the segment, the regret, a lower estimate when the reverse is also excluded
+        T excludeRaise = candidate.first;
+
+        T weakest = includeRaise < excludeRaise ? includeRaise : excludeRaise;
+        T sum = includeRaise + excludeRaise;
+        if (!found or bestWeakest < weakest or (bestWeakest == weakest and bestSum < sum)) {
+            bestWeakest = weakest;
+            bestSum = sum;
+            pos = candidate.second;
+            found = true;
+        }
+    }
+    return pos;
+}
+
+template<class T> pair<int, int> SubtourRule<T>::select(Little<T> &little, Matrix<T> &m, int id) {
+    const vector<int> &assignment = this->getAssignment(little);
+    if (assignment.empty()) {
+        return this->regretRule.select(little, m, id);
+    }
+
+    // End of the included path starting by each city
+    int nbCities = assignment.size();
+    vector<int> next(nbCities, -1);
+    for (const pair<int, int> &segment : this->getIncludedPath(little, id)) {
+        next[segment.first] = segment.second;
+    }
+
+    int size = m.getNbRows();
+    vector<int> rowByCity(nbCities, 0);
+    vector<int> colByCity(nbCities, 0);
+    for (int i = 1; i < size; i++) {
+        rowByCity[m.getValue(i, 0)] = i;
+        colByCity[m.getValue(0, i)] = i;
+    }
+
+    // Subtours : row city -> assigned column city -> end of its path, which is a row city
+    vector<bool> visited(nbCities, false);
+    vector<int> shortest;
+    for (int i = 1; i < size; i++) {
+        int start = m.getValue(i, 0);
+        if (visited[start]) {
+            continue;
+        }
+        vector<int> subtour;
+        int city = start;
+        while (city >= 0 and !visited[city] and rowByCity[city] != 0) {
+            visited[city] = true;
+            subtour.push_back(city);
+            city = assignment[city];
+            while (city >= 0 and next[city] >= 0) {
+                city = next[city];
+            }
+        }
+        if (city == start and (shortest.empty() or subtour.size() < shortest.size())) {
+            shortest = subtour;
+        }
+    }
+    if (shortest.empty() or shortest.size() == size - 1) {     // the assignment is already a tour
+        return this->regretRule.select(little, m, id);
+    }
+
+    pair<int, int> pos(1, 1);
+    T max = 0;
+    bool found = false;
+    for (int city : shortest) {
+        int i = rowByCity[city];
+        int j = colByCity[assignment[city]];
+        if (j == 0 or m.getValue(i, j) != 0) {
+            continue;
+        }
+        T val = this->getMinRow(little, m, i, j) + this->getMinCol(little, m, j, i);
+        if (!found or max < val) {
+            max = val;
+            pos = std::make_pair(i, j);
+            found = true;
+        }
+    }
+    if (!found) {
+        return this->regretRule.select(little, m, id);
+    }
+    return pos;
+}
+
+#endif  /* BRANCHINGRULE_H */
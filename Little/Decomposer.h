@@ -0,0 +1,366 @@
+#ifndef DECOMPOSER_H
+#define DECOMPOSER_H
+
+#include "Little.h"
+#include "LocalSearch.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/*
+ * Approximate tour of a large problem : the cities are partitioned into
+ * clusters of at most a given size by k-medoids on the costs, the order of
+ * the clusters is a small TSP between them, then each cluster is crossed by
+ * a path from its entry to its exit city, found by Little in parallel. The
+ * searches are bounded in nodes, those stopped before proving their tour
+ * optimal are counted. The tour is polished by 2-opt (symmetric problems)
+ * and Or-opt. The baseline is the nearest neighbour tour polished the same way
+ */
+template<class T>
+class Decomposer {
+private:
+    Matrix<T> matrix;               // problem, without the indexes
+    T infinity;
+    int clusterSize;                // largest number of cities of a cluster
+    bool symmetric;
+    vector<vector<int> > clusters;  // cities of each cluster, numbered from 0
+    vector<int> tour;               // decomposition tour, cities numbered from 1
+    vector<int> baselineTour;       // baseline tour, cities numbered from 1
+    std::atomic<long> nbNodes;      // nodes explored by the searches of the decomposition
+    std::atomic<int> nbTruncated;   // paths whose search reached pathNodeLimit
+    bool orderTruncated = false;    // search of the cluster order stopped by orderNodeLimit or not
+    double seconds = 0;
+    double baselineSeconds = 0;
+    static const long orderNodeLimit = 200000;      // nodes of the search of the cluster order
+    static const long pathNodeLimit = 1000000;      // nodes of the search of each path
+
+    T getDistance(int a, int b);
+    T getSegmentCost(int from, int to) { return this->matrix.getValue(from - 1, to - 1); }
+    void cluster();
+    vector<int> orderClusters();
+    vector<int> solvePath(const vector<int> &cities, int entry, int exit);
+    void polish(vector<int> &t);
+
+public:
+    Decomposer(const Matrix<T> &m, int clusterSize);
+    void solve();
+    void solveBaseline();
+    vector<int> getTour() { return this->tour; }                    // Return the decomposition tour
+    vector<int> getBaselineTour() { return this->baselineTour; }    // Return the baseline tour
+    T getTourCost(const vector<int> &t);
+    int getNbClusters() { return this->clusters.size(); }
+    long getNbNodes() { return this->nbNodes.load(); }
+    int getNbTruncated() { return this->nbTruncated.load(); }       // Return the number of paths not proven optimal
+    bool isOrderTruncated() { return this->orderTruncated; }        // Return whether the cluster order is not proven optimal
+    double getSeconds() { return this->seconds; }                   // Return the running time of the decomposition
+    double getBaselineSeconds() { return this->baselineSeconds; }   // Return the running time of the baseline
+};
+
+template<class T> Decomposer<T>::Decomposer(const Matrix<T> &m, int clusterSize)
+        : matrix(m), infinity(m.getEmptyValue()), clusterSize(clusterSize), symmetric(true), nbNodes(0), nbTruncated(0) {
+    int size = m.getNbRows();
+    for (int i = 0; i < size and this->symmetric; i++) {
+        for (int j = 0; j < i; j++) {
+            if (m.getValue(i, j) != m.getValue(j, i)) {
+                this->symmetric = false;
+                break;
+            }
+        }
+    }
+}
+
+// Return the cost of a tour, cities numbered from 1, infinity if it uses a missing segment
+template<class T> T Decomposer<T>::getTourCost(const vector<int> &t) {
+    T cost = 0;
+    int size = t.size();
+    for (int i = 0; i < size; i++) {
+        T segmentCost = getSegmentCost(t[i], t[(i + 1) % size]);
+        if (segmentCost == this->infinity) {
+            return this->infinity;
+        }
+        cost += segmentCost;
+    }
+    return cost;
+}
+
+// Dissimilarity of two cities (numbered from 0) for the clustering, both ways
+template<class T> T Decomposer<T>::getDistance(int a, int b) {
+    if (a == b) {
+        return 0;
+    }
+    T there = this->matrix.getValue(a, b);
+    T back = this->matrix.getValue(b, a);
+    if (there == this->infinity or back == this->infinity) {
+        return this->infinity;
+    }
+    return there + back;
+}
+
+/*
+ * Capacitated k-medoids : the medoids start by the most central city then
+ * the farthest ones, each city goes to the nearest medoid having room left,
+ * each medoid moves to the member nearest from the others, until it is stable
+ */
+template<class T> void Decomposer<T>::cluster() {
+    int size = this->matrix.getNbRows();
+    int k = (size + this->clusterSize - 1) / this->clusterSize;
+
+    // The sums of distances are kept in double, they may exceed T
+    vector<int> medoids;
+    double bestSum = std::numeric_limits<double>::max();
+    int central = 0;
+    for (int i = 0; i < size; i++) {
+        double sum = 0;
+        for (int j = 0; j < size and sum < bestSum; j++) {
+            sum += getDistance(i, j);
+        }
+        if (sum < bestSum) {
+            bestSum = sum;
+            central = i;
+        }
+    }
+    medoids.push_back(central);
+    vector<T> nearest(size);
+    for (int i = 0; i < size; i++) {
+        nearest[i] = getDistance(i, central);
+    }
+    while (medoids.size() < k) {
+        int farthest = std::max_element(nearest.begin(), nearest.end()) - nearest.begin();
+        medoids.push_back(farthest);
+        for (int i = 0; i < size; i++) {
+            nearest[i] = std::min(nearest[i], getDistance(i, farthest));
+        }
+    }
+
+    for (int iteration = 0; iteration < 20; iteration++) {
+        // Cities by distance to each medoid, the medoids first
+        vector<std::pair<T, pair<int, int> > > candidates;
+        candidates.reserve((size_t) size * k);
+        for (int c = 0; c < k; c++) {
+            for (int i = 0; i < size; i++) {
+                candidates.push_back(std::make_pair(i == medoids[c] ? -1 : getDistance(i, medoids[c]), std::make_pair(i, c)));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        vector<int> clusterOf(size, -1);
+        this->clusters.assign(k, vector<int>());
+        for (const std::pair<T, pair<int, int> > &candidate : candidates) {
+            int city = candidate.second.first;
+            int c = candidate.second.second;
+            if (clusterOf[city] < 0 and this->clusters[c].size() < this->clusterSize) {
+                clusterOf[city] = c;
+                this->clusters[c].push_back(city);
+            }
+        }
+
+        bool moved = false;
+        for (int c = 0; c < k; c++) {
+            double best = std::numeric_limits<double>::max();
+            int medoid = medoids[c];
+            for (int a : this->clusters[c]) {
+                double sum = 0;
+                for (int b : this->clusters[c]) {
+                    sum += getDistance(a, b);
+                }
+                if (sum < best) {
+                    best = sum;
+                    medoid = a;
+                }
+            }
+            moved = moved or medoid != medoids[c];
+            medoids[c] = medoid;
+        }
+        if (!moved) {
+            break;
+        }
+    }
+
+    // Medoids shared by several clusters, when cities are at no cost from each other
+    this->clusters.erase(std::remove_if(this->clusters.begin(), this->clusters.end(),
+                                        [](const vector<int> &members) { return members.empty(); }), this->clusters.end());
+}
+
+// Return the order of the clusters, a tour of the problem of the cheapest segments between them
+template<class T> vector<int> Decomposer<T>::orderClusters() {
+    int k = this->clusters.size();
+    vector<int> order;
+    if (k < 3) {
+        for (int c = 0; c < k; c++) {
+            order.push_back(c + 1);
+        }
+        return order;
+    }
+
+    Matrix<T> costs(k, k, this->infinity);
+    for (int a = 0; a < k; a++) {
+        for (int b = 0; b < k; b++) {
+            if (a == b) {
+                continue;
+            }
+            T min = this->infinity;
+            for (int from : this->clusters[a]) {
+                for (int to : this->clusters[b]) {
+                    min = std::min(min, this->matrix.getValue(from, to));
+                }
+            }
+            costs.setValue(a, b, min);
+        }
+    }
+
+    Little<T> little(costs);
+    little.setVerbose(false);
+    little.setSymmetric(true);
+    little.setInitialTour(nearestNeighbour(costs, 0));
+    little.setStopCondition([&little]() { return little.getNbNodes() >= orderNodeLimit; });
+    little.findTour();
+    this->nbNodes += little.getNbNodes();
+    this->orderTruncated = little.isStopped();
+    if (little.getLastTour().empty()) {
+        return nearestNeighbour(costs, 0);     // no tour of finite cost
+    }
+    return little.getLastTour();
+}
+
+/*
+ * Return the path from the entry to the exit city crossing all the cities
+ * of a cluster (numbered from 0), the shortest one found by Little : the
+ * exit city may only go back to the entry, at no cost. With the same entry
+ * and exit, the tour of the cluster starting by the entry
+ */
+template<class T> vector<int> Decomposer<T>::solvePath(const vector<int> &cities, int entry, int exit) {
+    int size = cities.size();
+    bool closed = entry == exit;
+    if (size == 1 or (size == 2 and !closed)) {
+        return closed ? vector<int>(1, entry) : vector<int>({entry, exit});
+    }
+
+    Matrix<T> costs(size, size, this->infinity);
+    int localEntry = 0, localExit = 0;
+    for (int i = 0; i < size; i++) {
+        localEntry = cities[i] == entry ? i : localEntry;
+        localExit = cities[i] == exit ? i : localExit;
+        for (int j = 0; j < size; j++) {
+            if (i != j) {
+                costs.setValue(i, j, this->matrix.getValue(cities[i], cities[j]));
+            }
+        }
+    }
+    for (int j = 0; j < size and !closed; j++) {
+        costs.setValue(localExit, j, j == localEntry ? 0 : this->infinity);
+    }
+
+    // Nearest neighbour path as the initial tour, so that a tour is known if the search is stopped
+    vector<int> initialTour = nearestNeighbour(costs, localEntry, closed ? -1 : localExit);
+
+    Little<T> little(costs);
+    little.setVerbose(false);
+    little.setInitialTour(initialTour);
+    little.setStopCondition([&little]() { return little.getNbNodes() >= pathNodeLimit; });
+    little.findTour();
+    this->nbNodes += little.getNbNodes();
+    if (little.isStopped()) {
+        this->nbTruncated++;
+    }
+
+    vector<int> localTour = little.getLastTour();
+    if (localTour.empty()) {
+        localTour = initialTour;        // no tour of finite cost
+    }
+    std::rotate(localTour.begin(), std::find(localTour.begin(), localTour.end(), localEntry + 1), localTour.end());
+    vector<int> path;
+    for (int city : localTour) {
+        path.push_back(cities[city - 1]);
+    }
+    return path;
+}
+
+// Local search of a tour, the tour then starts by the city 1
+template<class T> void Decomposer<T>::polish(vector<int> &t) {
+    if (t.size() < 5) {
+        return;
+    }
+    T cost = getTourCost(t);
+    T previous;
+    do {
+        previous = cost;
+        if (this->symmetric) {
+            twoOpt(this->matrix, t);
+        }
+        orOpt(this->matrix, t);
+        cost = getTourCost(t);
+    } while (cost < previous);
+    std::rotate(t.begin(), std::find(t.begin(), t.end(), 1), t.end());
+}
+
+// Build the tour by the decomposition
+template<class T> void Decomposer<T>::solve() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    cluster();
+    vector<int> order = orderClusters();
+    int k = order.size();
+    for (int &c : order) {
+        c--;
+    }
+
+    // Cheapest segment from each cluster to the next, leaving and entering a cluster by different cities
+    vector<int> entries(k, -1), exits(k, -1);
+    for (int i = 0; i < k and k > 1; i++) {
+        const vector<int> &from = this->clusters[order[i]];
+        const vector<int> &to = this->clusters[order[(i + 1) % k]];
+        int j = (i + 1) % k;
+        T best = std::numeric_limits<T>::max();
+        for (int a : from) {
+            if (a == entries[i] and from.size() > 1) {
+                continue;
+            }
+            for (int b : to) {
+                if (b == exits[j] and to.size() > 1) {
+                    continue;
+                }
+                if (this->matrix.getValue(a, b) < best) {
+                    best = this->matrix.getValue(a, b);
+                    exits[i] = a;
+                    entries[j] = b;
+                }
+            }
+        }
+    }
+
+    // One path per cluster, by as many threads as cores
+    vector<vector<int> > paths(k);
+    std::atomic<int> nextCluster(0);
+    std::function<void()> solvePaths = [this, &order, &entries, &exits, &paths, &nextCluster]() {
+        for (int i = nextCluster++; i < paths.size(); i = nextCluster++) {
+            const vector<int> &cities = this->clusters[order[i]];
+            paths[i] = paths.size() == 1 ? solvePath(cities, cities[0], cities[0]) : solvePath(cities, entries[i], exits[i]);
+        }
+    };
+    int nbThreads = std::max(1u, std::min(std::thread::hardware_concurrency(), (unsigned) k));
+    vector<std::thread> threads;
+    for (int i = 1; i < nbThreads; i++) {
+        threads.push_back(std::thread(solvePaths));
+    }
+    solvePaths();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    this->tour.clear();
+    for (const vector<int> &path : paths) {
+        for (int city : path) {
+            this->tour.push_back(city + 1);
+        }
+    }
+    polish(this->tour);
+    this->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Build the baseline tour, nearest neighbour then local search
+template<class T> void Decomposer<T>::solveBaseline() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    this->baselineTour = nearestNeighbour(this->matrix, 0);
+    polish(this->baselineTour);
+    this->baselineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif  /* DECOMPOSER_H */
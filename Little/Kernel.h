@@ -0,0 +1,288 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+// Included by Little.h, searches the small subproblems on fixed size matrices
+
+#include <array>
+
+template<class T> class Little;
+
+// Matrix of n cities with its indexes, as Matrix, kept in an array
+template<class T, int N>
+struct KernelMatrix {
+    std::array<T, (N + 1) * (N + 1)> cells;
+    T get(int i, int j) const { return this->cells[i * (N + 1) + j]; }
+    void set(int i, int j, T value) { this->cells[i * (N + 1) + j] = value; }
+};
+
+// Fragments formed by the included segments and the segments included in the kernel
+struct KernelState {
+    vector<int> startOf;                    // start city of the fragment ending at each city, 0 if none
+    vector<int> endOf;                      // end city of the fragment starting at each city, 0 if none
+    vector<pair<int, int> > included;       // segments included since the kernel node
+    int id;                                 // node of the tree where the kernel started
+};
+
+/*
+ * Search of the subtree of a node of N cities, the same as Little::findTour
+ * with the reduction bound and the regret rule, the matrix size being known
+ * at compile time. The child including a segment is searched by the kernel
+ * of N - 1 cities, the child excluding it by the same kernel, without any
+ * allocation nor tree node
+ */
+template<class T, int N>
+class Kernel {
+public:
+    static T getMinRow(const KernelMatrix<T, N> &m, int row, int ignoredCol, T infinity) {
+        T min = infinity;
+        for (int j = 1; j <= N; j++) {
+            T value = m.get(row, j);
+            if (value != infinity and j != ignoredCol) {
+                min = (min < value ? min : value);
+            }
+        }
+        return min;
+    }
+
+    static T getMinCol(const KernelMatrix<T, N> &m, int col, int ignoredRow, T infinity) {
+        T min = infinity;
+        for (int i = 1; i <= N; i++) {
+            T value = m.get(i, col);
+            if (value != infinity and i != ignoredRow) {
+                min = (min < value ? min : value);
+            }
+        }
+        return min;
+    }
+
+    // Reduce the rows then the columns, return the sum of the subtracted costs, infinity if a city has no segment left
+    static T reduce(KernelMatrix<T, N> &m, T infinity) {
+        T total = 0;
+        for (int i = 1; i <= N; i++) {
+            T min = getMinRow(m, i, -1, infinity);
+            if (min == infinity) {
+                return infinity;
+            }
+            for (int j = 1; j <= N; j++) {
+                if (m.get(i, j) != infinity) {
+                    m.set(i, j, m.get(i, j) - min);
+                }
+            }
+            total += min;
+        }
+        for (int j = 1; j <= N; j++) {
+            T min = getMinCol(m, j, -1, infinity);
+            if (min == infinity) {
+                return infinity;
+            }
+            for (int i = 1; i <= N; i++) {
+                if (m.get(i, j) != infinity) {
+                    m.set(i, j, m.get(i, j) - min);
+                }
+            }
+            total += min;
+        }
+        return total;
+    }
+
+    // Regret of the zero cell at row, col, infinity if it is the only segment left in its row or column
+    static T getRegret(const KernelMatrix<T, N> &m, int row, int col, T infinity) {
+        T minRow = getMinRow(m, row, col, infinity);
+        T minCol = getMinCol(m, col, row, infinity);
+        return (minRow == infinity or minCol == infinity) ? infinity : minRow + minCol;
+    }
+
+    // Zero cell of maximal regret, the first found wins the ties, as RegretRule
+    static T select(const KernelMatrix<T, N> &m, pair<int, int> &pos, T infinity) {
+        pos = pair<int, int>(1, 1);
+        T max = 0;
+        bool found = false;
+        for (int i = 1; i <= N; i++) {
+            for (int j = 1; j <= N; j++) {
+                if (m.get(i, j) == 0) {
+                    T val = getRegret(m, i, j, infinity);
+                    if (!found or max < val) {
+                        max = val;
+                        pos.first = i;
+                        pos.second = j;
+                        found = true;
+                    }
+                }
+            }
+        }
+        return getRegret(m, pos.first, pos.second, infinity);
+    }
+
+    // Search the subtree of the reduced matrix m of bound cost
+    static void search(Little<T> &little, KernelMatrix<T, N> &m, T cost, bool mirrorClosed, KernelState &state) {
+        T infinity = little.infinity;
+        while (cost < little.reference and !little.mustStop()) {
+            pair<int, int> pos;
+            T regret = select(m, pos, infinity);
+            if (m.get(pos.first, pos.second) != 0) {
+                return;     // no zero cell, a city has no segment left : the node has no tour
+            }
+            pair<int, int> path(m.get(pos.first, 0), m.get(0, pos.second));
+            little.nbKernelNodes += 2;
+
+            // Child including the segment, without its row and column
+            KernelMatrix<T, N - 1> child;
+            for (int i = 0, k = 0; i <= N; i++) {
+                if (i == pos.first) {
+                    continue;
+                }
+                for (int j = 0, l = 0; j <= N; j++) {
+                    if (j != pos.second) {
+                        child.set(k, l++, m.get(i, j));
+                    }
+                }
+                k++;
+            }
+
+            // Its fragment cannot be closed before the last segment
+            int start = state.startOf[path.first] != 0 ? state.startOf[path.first] : path.first;
+            int end = state.endOf[path.second] != 0 ? state.endOf[path.second] : path.second;
+            int previousEnd = state.endOf[start];
+            int previousStart = state.startOf[end];
+            state.endOf[start] = end;
+            state.startOf[end] = start;
+            pair<int, int> closing(0, 0);
+            for (int i = 1; i < N; i++) {
+                if (child.get(i, 0) == end) {
+                    closing.first = i;
+                }
+                if (child.get(0, i) == start) {
+                    closing.second = i;
+                }
+            }
+            if (closing.first != 0 and closing.second != 0) {
+                child.set(closing.first, closing.second, infinity);
+            }
+
+            state.included.push_back(path);
+            T childReduction = Kernel<T, N - 1>::reduce(child, infinity);
+            if (childReduction != infinity) {
+                Kernel<T, N - 1>::search(little, child, cost + childReduction, false, state);
+            }
+            state.included.pop_back();
+            state.endOf[start] = previousEnd;
+            state.startOf[end] = previousStart;
+
+            // Child excluding the segment, and its reverse when the tours are mirror closed
+            if (regret == infinity) {
+                return;     // the segment is the only one left in its row or column
+            }
+            T excludedCost = cost + regret;
+            if (!(excludedCost < little.reference)) {
+                return;
+            }
+            m.set(pos.first, pos.second, infinity);
+            if (mirrorClosed) {
+                m.set(path.second, path.first, infinity);
+            }
+            little.pollSharedBound();
+            T reduction = reduce(m, infinity);
+            if (reduction == infinity) {
+                return;
+            }
+            cost = (mirrorClosed and cost + reduction > excludedCost) ? cost + reduction : excludedCost;
+        }
+    }
+};
+
+// Last two segments of the tour, as in Little::findTour
+template<class T>
+class Kernel<T, 2> {
+public:
+    static T reduce(KernelMatrix<T, 2> &m, T infinity) {
+        T total = 0;
+        for (int i = 1; i <= 2; i++) {
+            T min = infinity;
+            for (int j = 1; j <= 2; j++) {
+                T value = m.get(i, j);
+                min = (value != infinity and value < min) ? value : min;
+            }
+            if (min == infinity) {
+                return infinity;
+            }
+            for (int j = 1; j <= 2; j++) {
+                if (m.get(i, j) != infinity) {
+                    m.set(i, j, m.get(i, j) - min);
+                }
+            }
+            total += min;
+        }
+        for (int j = 1; j <= 2; j++) {
+            T min = infinity;
+            for (int i = 1; i <= 2; i++) {
+                T value = m.get(i, j);
+                min = (value != infinity and value < min) ? value : min;
+            }
+            if (min == infinity) {
+                return infinity;
+            }
+            for (int i = 1; i <= 2; i++) {
+                if (m.get(i, j) != infinity) {
+                    m.set(i, j, m.get(i, j) - min);
+                }
+            }
+            total += min;
+        }
+        return total;
+    }
+
+    static void search(Little<T> &little, KernelMatrix<T, 2> &m, T cost, bool, KernelState &state) {
+        if (cost < little.reference) {
+            Matrix<T> last(3, 3, little.infinity);
+            for (int i = 0; i <= 2; i++) {
+                for (int j = 0; j <= 2; j++) {
+                    last.setValue(i, j, m.get(i, j));
+                }
+            }
+            // The segments included in the kernel become nodes of the tree, kept if the leaf gives a tour
+            size_t treeSize = little.tree.size();
+            long parent = state.id;
+            for (const pair<int, int> &segment : state.included) {
+                Node<T> node;
+                node.cost = cost;
+                node.path = segment;
+                node.parentNodeKey = parent;
+                little.tree.push_back(node);
+                parent = little.tree.size() - 1;
+            }
+            T reference = little.reference;
+            little.updateTour(last, cost);
+            if (little.reference < reference) {
+                little.nbKernelNodes -= state.included.size();      // already counted
+            }
+            else {
+                little.tree.resize(treeSize);
+            }
+        }
+    }
+};
+
+// Run the kernel of the size of the matrix m, from N cities down to 3
+template<class T, int N>
+struct KernelDispatch {
+    static void run(Little<T> &little, Matrix<T> &m, bool mirrorClosed, KernelState &state) {
+        if (m.getNbRows() - 1 != N) {
+            KernelDispatch<T, N - 1>::run(little, m, mirrorClosed, state);
+            return;
+        }
+        KernelMatrix<T, N> kernelMatrix;
+        for (int i = 0; i <= N; i++) {
+            for (int j = 0; j <= N; j++) {
+                kernelMatrix.set(i, j, m.getValue(i, j));
+            }
+        }
+        Kernel<T, N>::search(little, kernelMatrix, little.tree[state.id].cost, mirrorClosed, state);
+    }
+};
+
+template<class T>
+struct KernelDispatch<T, 2> {
+    static void run(Little<T> &, Matrix<T> &, bool, KernelState &) {}
+};
+
+#endif  /* KERNEL_H */
@@ -2,11 +2,16 @@
 #define LITTLE_H
 
 #include "../Matrix/Matrix.h"
+#include "../Matrix/SymmetricMatrix.h"
 #include <iostream>
 #include <limits>
 #include <deque>
 #include <stack>
 #include <utility>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <numeric>
 
 using std::stack;
 using std::deque;
@@ -20,11 +25,40 @@ struct Node {
     T cost;                     // path cost till this node
     pair<int, int> path;        // path segment (example : 0 1)
     bool bar = false;           // included or excluded path segment
+    bool mirrorClosed = false;  // holding the reverse of each of its tours (symmetric problem, only excluded segments)
     long parentNodeKey = -1;     // parent id node (in tree)
 };
 
+// Matrix kept on the stack to pursue another branch of the tree
+template<class T>
+struct OpenNode {
+    int id;                     // node id (in tree)
+    Matrix<T> matrix;           // reduced matrix of the node
+    vector<int> assignment;     // column city assigned to each row city, with the assignment bound
+};
+
+// Part of the search : the tours including and excluding the given segments
+template<class T>
+struct Subproblem {
+    vector<pair<int, int> > included;   // included segments, in the order of their inclusion
+    vector<pair<int, int> > excluded;   // excluded segments
+    T bound = 0;                        // lower bound of the cost of its tours
+};
+
+template<class T> class BranchingRule;
+template<class T, int N> class Kernel;
+template<class T, int N> struct KernelDispatch;
+struct KernelState;
+
+#include "SpillFile.h"
+#include "TranspositionTable.h"
+
 template<class T>
 class Little {
+    friend class BranchingRule<T>;
+    template<class U, int N> friend class Kernel;
+    template<class U, int N> friend struct KernelDispatch;
+
 private:
     T infinity;                                     // value considered as infinity
     Matrix<T> initialMatrix;                        // initial matrix
@@ -32,26 +66,85 @@ private:
     deque<Node<T> > tree;                           // tree storing the nodes
     vector<int> lastTour;                           // last found tour
     bool optimal = 0;                               // optimal path or not
+    bool stopped = 0;                               // search interrupted before completion or not
+    bool spillFailed = 0;                           // search stopped by an error of the spill file or not
+    bool verbose = 1;                               // print the search progress in debug mode or not
+    std::function<void(T, const vector<int>&)> tourCallback;   // called on each improved tour
+    std::function<bool()> stopCondition;            // polled during the search, stops it when true
+    std::shared_ptr<BranchingRule<T> > branchingRule;   // choice of the segment to branch on
+    bool assignmentBound = 0;                       // bound by the assignment problem instead of the reduction
+    bool symmetric = 0;                             // symmetric problem, each tour costs as much as its reverse
+    vector<int> assignment;                         // assignment of the current node, with the assignment bound
+    size_t memoryLimit = 0;                         // bytes of the open nodes kept in memory, 0 for no limit
+    std::unique_ptr<SpillFile<T> > spillFile;       // open nodes beyond the memory limit
+    Subproblem<T> constraints;                      // part of the search to explore, the whole one if empty
+    std::function<T()> sharedBound;                 // polled during the search, cost of a tour found elsewhere
+    std::function<bool()> shareRequested;           // polled during the search, true when an open node is wanted
+    std::function<void(const Subproblem<T>&)> shareCallback;   // given the wanted open node
+    std::shared_ptr<TranspositionTable<T> > transpositionTable;   // subproblems already reached, none if empty
+    int kernelSize = maxKernelSize;                 // largest subproblem searched by the fixed size kernels, 0 for none
+    long nbKernelNodes = 0;                         // nodes searched by the kernels, not stored in the tree
+    bool mustStop();
+    void pollSharedBound();
     T getMinRow(Matrix<T> &m, int row, int ignoredCol = -1);
     T getMinCol(Matrix<T> &m, int col, int ignoredRow = -1);
     T reduceRow(Matrix<T> &m, int row);
     T reduceCol(Matrix<T> &m, int col);
     T reduceMatrix(Matrix<T> &m);
-    T calculateRegret(Matrix<T> &m, pair<int, int> &path, pair<int, int> &pos);
+    T reduceAssignment(Matrix<T> &m, vector<int> &assignment);
+    T reduce(Matrix<T> &m, vector<int> &assignment);
+    T calculateRegret(Matrix<T> &m, int id, pair<int, int> &path, pair<int, int> &pos);
     void removeSubTour(Matrix<T> &m, int index, pair<int, int> &path);
     void addIndices(Matrix<T> &m);
     vector<int> orderPath(int index, int begin);
     void addLastPath(Matrix<T> &m);
     void checkTourCost();
+    void updateTour(Matrix<T> &m, T cost);
+    bool useKernel(Matrix<T> &m);
+    void searchKernel(Matrix<T> &m, int id);
+    static size_t getSize(const OpenNode<T> &node);
+    void spill(vector<OpenNode<T> > &matrices, size_t &frontierSize);
+    void readSpilled(vector<OpenNode<T> > &matrices, size_t &frontierSize);
+    bool applyConstraints(OpenNode<T> &start);
+    Subproblem<T> getSubproblem(int id);
+    void splitNode(OpenNode<T> &node, int depth, const Subproblem<T> &constraints, vector<Subproblem<T> > &subproblems);
+    bool isDuplicate(Matrix<T> &m, int id);
 
 public:
-    Little(Matrix<T> &m);
+    Little(const Matrix<T> &m);
+    Little(const SymmetricMatrix<T> &m);
+    Little(const T *costs, int size, T infinity);
     void findTour();
+    T getTourCost(const vector<int> &tour);
+    bool setInitialTour(const vector<int> &tour);
+    bool setConstraints(const Subproblem<T> &subproblem);
+    bool setSymmetric(bool symmetric);
+    vector<Subproblem<T> > split(int depth);
     vector<int> getLastTour() { return this->lastTour; }    // Return the last found tour
     int getCost() { return this->reference; }               // Return the last found tour cost
     bool isOptimal() { return this->optimal; }              // Return whether the tour is optimal
+    bool isStopped() { return this->stopped; }              // Return whether the search has been interrupted
+    bool hasSpillFailed() { return this->spillFailed; }     // Return whether the spill file failed, the search being stopped
+    long getNbNodes() { return this->tree.size() + this->nbKernelNodes; }  // Return the number of nodes of the search tree
+    void setVerbose(bool verbose) { this->verbose = verbose; }
+    void setTourCallback(std::function<void(T, const vector<int>&)> callback) { this->tourCallback = callback; }
+    void setStopCondition(std::function<bool()> condition) { this->stopCondition = condition; }
+    void setBranchingRule(std::shared_ptr<BranchingRule<T> > rule) { this->branchingRule = rule; }
+    void setAssignmentBound(bool assignmentBound) { this->assignmentBound = assignmentBound; }
+    void setMemoryLimit(size_t memoryLimit) { this->memoryLimit = memoryLimit; }
+    void setSharedBound(std::function<T()> bound) { this->sharedBound = bound; }
+    void setTranspositionTable(std::shared_ptr<TranspositionTable<T> > table) { this->transpositionTable = table; }
+    bool setKernelSize(int size);
+    static const int maxKernelSize = 16;            // largest fixed size kernel
+    void setWorkSharing(std::function<bool()> requested, std::function<void(const Subproblem<T>&)> callback) {
+        this->shareRequested = requested;
+        this->shareCallback = callback;
+    }
 };
 
+#include "BranchingRule.h"
+#include "Kernel.h"
+
 // Return the minimum of a row in a matrix
 template<class T> T Little<T>::getMinRow(Matrix<T> &m, int row, int ignoredCol) {
     int nbCol = m.getNbColumns();
@@ -123,28 +216,130 @@ template<class T> T Little<T>::reduceMatrix(Matrix<T> &m) {
 };
 
 /*
- * Return the path segment and the cell position
- * in the matrix containing the maximal regret
+ * Reduce the matrix by the dual potentials of its assignment problem, and
+ * return the sum of the subtracted costs, the assignment problem value.
+ * The matrix is first reduced by rows and columns, then the cities still
+ * assigned as in the parent node (by a zero cell) are kept, and each other
+ * row gets one shortest augmenting path (Hungarian algorithm). Forcing or
+ * forbidding a segment thus only costs one augmentation
  */
-template<class T> T Little<T>::calculateRegret(Matrix<T> &m, pair<int, int> &path, pair<int, int> &pos) {
-    int size = m.getNbRows();
-    int max = -1;
-    for (int i = 1; i < size; i++) {
-        for (int j = 1; j < size; j++) {
-            if (m.getValue(i, j) == 0) {
-                T val = getMinRow(m, i, j) + getMinCol(m, j, i);
-                if (max < val || max < 0) {
-                    max = val;
-                    pos.first = i;
-                    pos.second = j;
-
-                    path.first = m.getValue(i, 0);
-                    path.second = m.getValue(0, j);
+template<class T> T Little<T>::reduceAssignment(Matrix<T> &m, vector<int> &assignment) {
+    T total = reduceMatrix(m);
+    if (total >= this->infinity) {
+        return this->infinity;
+    }
+
+    int size = m.getNbRows() - 1;
+    T unreachable = std::numeric_limits<T>::max();
+    vector<T> u(size + 1, 0);           // row potentials
+    vector<T> v(size + 1, 0);           // column potentials
+    vector<int> matchedRow(size + 1, 0);    // row matched to each column, 0 if none
+    vector<bool> matched(size + 1, false);
+
+    // Assignment of the parent node, where still valid
+    if (!assignment.empty()) {
+        vector<int> colByCity(assignment.size(), 0);
+        for (int j = 1; j <= size; j++) {
+            colByCity[m.getValue(0, j)] = j;
+        }
+        for (int i = 1; i <= size; i++) {
+            int city = assignment[m.getValue(i, 0)];
+            int j = city >= 0 ? colByCity[city] : 0;
+            if (j != 0 and matchedRow[j] == 0 and m.getValue(i, j) == 0) {
+                matchedRow[j] = i;
+                matched[i] = true;
+            }
+        }
+    }
+
+    // Shortest augmenting path from each unmatched row
+    vector<T> minv(size + 1);
+    vector<int> way(size + 1);
+    vector<bool> used(size + 1);
+    for (int i = 1; i <= size; i++) {
+        if (matched[i]) {
+            continue;
+        }
+        matchedRow[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), unreachable);
+        std::fill(used.begin(), used.end(), false);
+        do {
+            used[j0] = true;
+            int i0 = matchedRow[j0];
+            T delta = unreachable;
+            int j1 = -1;
+            for (int j = 1; j <= size; j++) {
+                if (used[j]) {
+                    continue;
+                }
+                T value = m.getValue(i0, j);
+                if (value != this->infinity and value - u[i0] - v[j] < minv[j]) {
+                    minv[j] = value - u[i0] - v[j];
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            if (j1 < 0) {       // no complete assignment with the remaining segments
+                return this->infinity;
+            }
+            for (int j = 0; j <= size; j++) {
+                if (used[j]) {
+                    u[matchedRow[j]] += delta;
+                    v[j] -= delta;
+                }
+                else if (minv[j] != unreachable) {
+                    minv[j] -= delta;
                 }
             }
+            j0 = j1;
+        } while (matchedRow[j0] != 0);
+        do {
+            int j1 = way[j0];
+            matchedRow[j0] = matchedRow[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    // Reduction by the potentials, the assigned cells become zeros
+    T potentials = 0;
+    for (int i = 1; i <= size; i++) {
+        potentials += u[i] + v[i];
+        for (int j = 1; j <= size; j++) {
+            T value = m.getValue(i, j);
+            if (value != this->infinity) {
+                m.setValue(i, j, value - u[i] - v[j]);
+            }
         }
     }
-    return max;
+
+    assignment.assign(this->initialMatrix.getNbRows(), -1);
+    for (int j = 1; j <= size; j++) {
+        assignment[m.getValue(matchedRow[j], 0)] = m.getValue(0, j);
+    }
+    return total + potentials;
+}
+
+// Reduce the matrix with the chosen bound
+template<class T> T Little<T>::reduce(Matrix<T> &m, vector<int> &assignment) {
+    if (this->assignmentBound) {
+        return reduceAssignment(m, assignment);
+    }
+    return reduceMatrix(m);
+}
+
+/*
+ * Return the path segment and the cell position in the matrix chosen by the
+ * branching rule for the node id, and the regret of excluding this segment
+ */
+template<class T> T Little<T>::calculateRegret(Matrix<T> &m, int id, pair<int, int> &path, pair<int, int> &pos) {
+    pos = this->branchingRule->select(*this, m, id);
+    path.first = m.getValue(pos.first, 0);
+    path.second = m.getValue(0, pos.second);
+    return getMinRow(m, pos.first, pos.second) + getMinCol(m, pos.second, pos.first);
 };
 
 // Search and remove the subtour
@@ -260,47 +455,110 @@ template<class T> void Little<T>::findTour() {
     Node<T> regretNode;     // node without regret
     regretNode.bar = true;
     pair<int, int> pos;     // var to store the position of a cell in the matrix
-    stack<pair<int, Matrix<T> > > matrices;    // stack containing the necessary matrix to pursue other branch of the tree
-    pair<int, Matrix<T> > matrix;   // matrix associated to a node
+    vector<OpenNode<T> > matrices;  // stack containing the necessary matrix to pursue other branch of the tree
+    size_t frontierSize = 0;        // memory used by the stack
+    OpenNode<T> matrix;     // matrix associated to a node
 
     // Init of the stack with the initial distances matrix
-    matrix.first = 0;
-    matrix.second = initialMatrix;
-    matrices.push(matrix);
+    matrix.id = 0;
+    matrix.matrix = initialMatrix;
+    if (this->constraints.included.empty() and this->constraints.excluded.empty()) {
+        matrices.push_back(matrix);
+    }
+    else if (applyConstraints(matrix)) {
+        matrices.push_back(matrix);     // the constrained node starts the search
+    }
+    if (this->memoryLimit > 0 and !matrices.empty()) {
+        frontierSize += getSize(matrix);
+    }
 
-    while (!matrices.empty()) {     // Iterate till the stack is empty
-        int id = matrices.top().first;
-        Matrix<T> m = matrices.top().second;
-        matrices.pop();
+    // Iterate till the stack and the spill file are empty
+    while ((!matrices.empty() or (this->spillFile and !this->spillFile->empty())) and !mustStop()) {
+        if (matrices.empty()) {
+            readSpilled(matrices, frontierSize);
+            if (matrices.empty()) {
+                break;      // the spilled nodes cannot improve the reference, or cannot be read
+            }
+        }
+        pollSharedBound();
+        if (this->shareRequested and matrices.size() >= 2 and this->shareRequested()) {
+            // The bottom of the stack, nearest from the root, is given away
+            this->shareCallback(getSubproblem(matrices.front().id));
+            if (this->memoryLimit > 0) {
+                frontierSize -= getSize(matrices.front());
+            }
+            matrices.erase(matrices.begin());
+        }
+
+        int id = matrices.back().id;
+        Matrix<T> m = matrices.back().matrix;
+        this->assignment = matrices.back().assignment;
+        if (this->memoryLimit > 0) {
+            frontierSize -= getSize(matrices.back());
+        }
+        matrices.pop_back();
 
         // Reduction of the matrix and computation of the minimum sum (raw + col)
-        normalNode.cost = reduceMatrix(m);
+        normalNode.cost = reduce(m, this->assignment);
         if (id == 0) {      // root tree case
+            normalNode.mirrorClosed = this->symmetric;
             tree.push_back(normalNode);
+            normalNode.mirrorClosed = false;
+        }
+        else if (this->assignmentBound or tree[id].mirrorClosed) {
+            // The bound of the node may exceed its parent cost plus its regret
+            T bound = tree[tree[id].parentNodeKey].cost + normalNode.cost;
+            if (bound > tree[id].cost) {
+                tree[id].cost = bound;
+            }
+        }
+        if (id != 0) {
+            normalNode.cost = tree[id].cost;
         }
 
         /* Until it ends up with a 2x2 matrix (3x3 du to the indexes storage)
          * and until the current node is lower than the reference value */
-        while (m.getNbRows() > 3 and tree[id].cost < this->reference) {
+        while (m.getNbRows() > 3 and tree[id].cost < this->reference and !mustStop() and !isDuplicate(m, id)) {
+            if (useKernel(m)) {
+                searchKernel(m, id);    // the whole subtree of the node
+                break;
+            }
 
 #ifdef DEBUG
-            if ((tree.size() - 1) % 10000 == 0) {
+            if (this->verbose and (tree.size() - 1) % 10000 == 0) {
                 cout << "\r" << tree.size() - 1 << " nodes ..." << std::flush;
             }
 #endif
 
             // Compute the node with regret
-            regretNode.cost = tree[id].cost + calculateRegret(m, normalNode.path, pos);
+            regretNode.cost = tree[id].cost + calculateRegret(m, id, normalNode.path, pos);
+            if (m.getValue(pos.first, pos.second) != 0) {
+                break;      // no zero cell, a city has no segment left : the node has no tour
+            }
+            regretNode.path = normalNode.path;
+            regretNode.mirrorClosed = tree[id].mirrorClosed;
             regretNode.parentNodeKey = id;
             tree.push_back(regretNode);
 
             // Storing of the matrix
             if (regretNode.cost < this->reference) {
-                matrix.first = tree.size() - 1;
-                matrix.second = m;
-                matrix.second.setValue(pos.first, pos.second,
+                matrix.id = tree.size() - 1;
+                matrix.matrix = m;
+                matrix.matrix.setValue(pos.first, pos.second,
                                        this->infinity);      // Suppression case i, j pour une potentielle recherche ulterieur
-                matrices.push(matrix);
+                if (regretNode.mirrorClosed) {
+                    /* The tours using the reverse segment are the mirrors of the tours of the
+                     * including child, no row nor column has been removed from the matrix */
+                    matrix.matrix.setValue(normalNode.path.second, normalNode.path.first, this->infinity);
+                }
+                matrix.assignment = this->assignment;
+                matrices.push_back(matrix);
+                if (this->memoryLimit > 0) {
+                    frontierSize += getSize(matrix);
+                    if (frontierSize > this->memoryLimit) {
+                        spill(matrices, frontierSize);
+                    }
+                }
             }
 
             // Deletion raw col
@@ -311,7 +569,7 @@ template<class T> void Little<T>::findTour() {
             removeSubTour(m, tree.size() - 1, normalNode.path);
 
             // Compute the node without regret
-            normalNode.cost = tree[id].cost + reduceMatrix(m);
+            normalNode.cost = tree[id].cost + reduce(m, this->assignment);
             normalNode.parentNodeKey = id;
             tree.push_back(normalNode);
 
@@ -319,34 +577,485 @@ template<class T> void Little<T>::findTour() {
         }
 
         // Update of the best tour and the reference value
-        if (m.getNbRows() == 3) {
-            if (normalNode.cost < this->reference) {
-                addLastPath(m);
-                this->reference = normalNode.cost;
-                this->lastTour = orderPath(tree.size() - 1, 1);
+        if (m.getNbRows() == 3 and normalNode.cost < this->reference) {
+            updateTour(m, normalNode.cost);
+        }
+    }
+
+    if (this->spillFile and (this->spillFile->hasFailed() or !this->spillFile->empty())) {
+        this->spillFailed = this->spillFile->hasFailed();
+        this->stopped = true;       // spilled nodes left unexplored
+    }
+    this->optimal = !this->stopped;   // Computing finished, the tour is thus optimal
 
 #ifdef DEBUG
-                cout << "\r";
-                checkTourCost();
-                cout << "Cost " << this->reference;
-                cout << " Tour ";
-                for (int i = 0; i < this->lastTour.size(); i++) {
-                    cout << this->lastTour[i] << " ";
-                }
-                cout << "Node " << tree.size() - 1;
-                cout << endl;
-#endif
-            }
+    if (this->verbose) {
+        cout << endl << getNbNodes() << " nodes visited" << endl;
+        if (this->spillFile) {
+            SpillFile<T> &spilled = *this->spillFile;
+            double megabytesWritten = spilled.getBytesWritten() / 1048576.0;
+            double megabytesRead = spilled.getBytesRead() / 1048576.0;
+            cout << spilled.getNbWritten() << " nodes spilled, " << megabytesWritten << " MB written at "
+                 << (spilled.getWriteSeconds() > 0 ? megabytesWritten / spilled.getWriteSeconds() : 0) << " MB/s" << endl;
+            cout << spilled.getNbRead() << " nodes read back, " << megabytesRead << " MB read at "
+                 << (spilled.getReadSeconds() > 0 ? megabytesRead / spilled.getReadSeconds() : 0) << " MB/s, "
+                 << spilled.getNbPruned() << " pruned without reading" << endl;
+        }
+        if (this->transpositionTable) {
+            TranspositionTable<T> &table = *this->transpositionTable;
+            cout << table.getNbLookups() << " subproblems looked up, " << table.getNbHits() << " reached again, "
+                 << table.getNbPruned() << " pruned as dominated, " << table.getNbEvictions() << " evictions in "
+                 << table.getNbEntries() << " entries" << endl;
         }
     }
+#endif
+}
 
-    this->optimal = true;   // Computing finished, the tour is thus optimal
+/*
+ * Store the tour ending by the last two segments of the 2x2 matrix m, the
+ * other segments being included by the last node of the tree. Nothing is
+ * stored if the tour needs a missing segment, the problem may have no tour
+ */
+template<class T> void Little<T>::updateTour(Matrix<T> &m, T cost) {
+    bool closable = (m.getValue(1, 1) != this->infinity and m.getValue(2, 2) != this->infinity) or
+                    (m.getValue(1, 2) != this->infinity and m.getValue(2, 1) != this->infinity);
+    if (!closable) {
+        return;
+    }
+    size_t treeSize = tree.size();
+    addLastPath(m);
+    vector<int> tour = orderPath(tree.size() - 1, 1);
+    int size = tour.size();
+    for (int i = 0; i < size; i++) {
+        if (this->initialMatrix.getValue(tour[i], tour[(i + 1) % size]) == this->infinity) {
+            tree.resize(treeSize);
+            return;
+        }
+    }
+    this->reference = cost;
+    this->lastTour = tour;
+    if (this->tourCallback) {
+        this->tourCallback(this->reference, this->lastTour);
+    }
 
 #ifdef DEBUG
-    cout << endl << tree.size() << " nodes visited" << endl;
+    if (this->verbose) {
+        cout << "\r";
+        checkTourCost();
+        cout << "Cost " << this->reference;
+        cout << " Tour ";
+        for (int i = 0; i < this->lastTour.size(); i++) {
+            cout << this->lastTour[i] << " ";
+        }
+        cout << "Node " << getNbNodes() - 1;
+        cout << endl;
+    }
 #endif
 }
 
+/*
+ * Return whether the subtree of the matrix m is searched by a fixed size
+ * kernel : it is small enough, and the kernels only implement the reduction
+ * bound, the regret rule and no transposition table
+ */
+template<class T> bool Little<T>::useKernel(Matrix<T> &m) {
+    int size = m.getNbRows() - 1;
+    return size <= this->kernelSize and size > 2 and !this->assignmentBound and !this->transpositionTable and
+           dynamic_cast<RegretRule<T>*>(this->branchingRule.get()) != nullptr;
+}
+
+// Search the subtree of the node id, of matrix m, with the kernel of its size
+template<class T> void Little<T>::searchKernel(Matrix<T> &m, int id) {
+    int size = this->initialMatrix.getNbRows();
+    KernelState state;
+    state.startOf.assign(size, 0);
+    state.endOf.assign(size, 0);
+    state.id = id;
+
+    // Fragments of the included segments
+    vector<int> next(size, 0);
+    vector<bool> hasPrevious(size, false);
+    for (int index = id; index != 0; index = tree[index].parentNodeKey) {
+        if (!tree[index].bar) {
+            next[tree[index].path.first] = tree[index].path.second;
+            hasPrevious[tree[index].path.second] = true;
+        }
+    }
+    for (int city = 1; city < size; city++) {
+        if (next[city] != 0 and !hasPrevious[city]) {
+            int end = city;
+            while (next[end] != 0) {
+                end = next[end];
+            }
+            state.endOf[city] = end;
+            state.startOf[end] = city;
+        }
+    }
+    KernelDispatch<T, maxKernelSize>::run(*this, m, tree[id].mirrorClosed, state);
+}
+
+// Return the memory used by an open node, approximately
+template<class T> size_t Little<T>::getSize(const OpenNode<T> &node) {
+    return sizeof(OpenNode<T>) + node.matrix.getNbRows() * (sizeof(vector<T>) + node.matrix.getNbColumns() * sizeof(T)) +
+           node.assignment.size() * sizeof(int);
+}
+
+/*
+ * Move the open nodes of the largest bounds to the spill file, until the
+ * stack uses half of the memory limit. The nodes which cannot improve the
+ * reference anymore are dropped, the others keep their order in the stack
+ */
+template<class T> void Little<T>::spill(vector<OpenNode<T> > &matrices, size_t &frontierSize) {
+    if (!this->spillFile) {
+        this->spillFile.reset(new SpillFile<T>(this->infinity));
+    }
+    if (!this->spillFile->isOpen()) {
+        return;     // no temporary file, the nodes stay in memory
+    }
+
+    vector<int> order(matrices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this, &matrices](int a, int b) {
+        return tree[matrices[a].id].cost > tree[matrices[b].id].cost;
+    });
+
+    vector<bool> removed(matrices.size(), false);
+    vector<OpenNode<T> > batch;
+    vector<T> bounds;
+    for (int k : order) {
+        if (frontierSize <= this->memoryLimit / 2) {
+            break;
+        }
+        frontierSize -= getSize(matrices[k]);
+        removed[k] = true;
+        if (tree[matrices[k].id].cost < this->reference) {
+            bounds.push_back(tree[matrices[k].id].cost);
+            batch.push_back(std::move(matrices[k]));
+        }
+    }
+
+    // Smallest bounds first in the file, they are read back first
+    std::reverse(batch.begin(), batch.end());
+    std::reverse(bounds.begin(), bounds.end());
+    this->spillFile->write(batch, bounds);
+
+    int kept = 0;
+    for (int k = 0; k < matrices.size(); k++) {
+        if (!removed[k]) {
+            matrices[kept++] = std::move(matrices[k]);
+        }
+    }
+    matrices.resize(kept);
+}
+
+/*
+ * Read back the spilled nodes of the smallest bounds, until the stack uses
+ * half of the memory limit but at least one, the smallest bound ending on
+ * top of the stack
+ */
+template<class T> void Little<T>::readSpilled(vector<OpenNode<T> > &matrices, size_t &frontierSize) {
+    OpenNode<T> node;
+    while ((matrices.empty() or frontierSize < this->memoryLimit / 2) and this->spillFile->read(node, this->reference)) {
+        frontierSize += getSize(node);
+        matrices.push_back(std::move(node));
+    }
+    std::reverse(matrices.begin(), matrices.end());
+}
+
+/*
+ * Build the branch of the tree leading to the constrained node : the root
+ * excluding the excluded segments, then one node per included segment.
+ * Return false if the constraints leave no tour
+ */
+template<class T> bool Little<T>::applyConstraints(OpenNode<T> &start) {
+    Matrix<T> &m = start.matrix;
+    for (const pair<int, int> &segment : this->constraints.excluded) {
+        m.setValue(segment.first, segment.second, this->infinity);     // the initial matrix is ordered by city
+    }
+
+    // Without included segment, excluding both directions of each segment keeps the node mirror closed
+    bool mirrorClosed = this->symmetric and this->constraints.included.empty();
+    for (int i = 1; mirrorClosed and i < m.getNbRows(); i++) {
+        for (int j = 1; j < i; j++) {
+            if ((m.getValue(i, j) == this->infinity) != (m.getValue(j, i) == this->infinity)) {
+                mirrorClosed = false;
+                break;
+            }
+        }
+    }
+
+    Node<T> node;
+    node.cost = reduce(m, start.assignment);
+    node.mirrorClosed = mirrorClosed;
+    tree.push_back(node);
+    for (const pair<int, int> &segment : this->constraints.excluded) {
+        const vector<pair<int, int> > &excluded = this->constraints.excluded;
+        if (mirrorClosed and segment.first > segment.second and
+                std::find(excluded.begin(), excluded.end(), std::make_pair(segment.second, segment.first)) != excluded.end()) {
+            continue;       // the mirror of an excluded segment, implied by the mirror closed node as in findTour
+        }
+        node.bar = true;
+        node.path = segment;
+        node.parentNodeKey = tree.size() - 1;
+        tree.push_back(node);
+    }
+
+    node.bar = false;
+    node.mirrorClosed = false;
+    for (pair<int, int> segment : this->constraints.included) {
+        if (node.cost >= this->infinity) {
+            return false;
+        }
+        int size = m.getNbRows();
+        pair<int, int> pos(0, 0);
+        for (int i = 1; i < size; i++) {
+            if (m.getValue(i, 0) == segment.first) {
+                pos.first = i;
+            }
+            if (m.getValue(0, i) == segment.second) {
+                pos.second = i;
+            }
+        }
+        if (pos.first == 0 or pos.second == 0 or m.getValue(pos.first, pos.second) == this->infinity) {
+            return false;
+        }
+        m.removeRow(pos.first);
+        m.removeColumn(pos.second);
+        removeSubTour(m, tree.size() - 1, segment);
+        node.cost += reduce(m, start.assignment);
+        node.path = segment;
+        node.parentNodeKey = tree.size() - 1;
+        tree.push_back(node);
+    }
+    start.id = tree.size() - 1;
+    return node.cost < this->infinity;
+}
+
+/*
+ * Return whether the subproblem of the node id, of matrix m, has already
+ * been reached by another branch with included segments costing at most as
+ * much. Its key is made of its remaining rows and columns, its forbidden
+ * cells, the start and end of each path fragment, and whether the reverse
+ * tours are left out, which determine its completions
+ */
+template<class T> bool Little<T>::isDuplicate(Matrix<T> &m, int id) {
+    if (!this->transpositionTable) {
+        return false;
+    }
+    typedef TranspositionTable<T> Table;
+    const uint64_t rowFeature = 1ULL << 60, colFeature = 2ULL << 60, cellFeature = 3ULL << 60,
+                   fragmentFeature = 4ULL << 60, mirrorFeature = 5ULL << 60;
+
+    int nbRows = m.getNbRows();
+    int nbCols = m.getNbColumns();
+    uint64_t key = tree[id].mirrorClosed ? Table::getKey(mirrorFeature) : 0;
+    for (int i = 1; i < nbRows; i++) {
+        uint64_t row = m.getValue(i, 0);
+        key ^= Table::getKey(rowFeature | row);
+        for (int j = 1; j < nbCols; j++) {
+            if (m.getValue(i, j) == this->infinity) {
+                key ^= Table::getKey(cellFeature | row << 30 | (uint64_t) m.getValue(0, j));
+            }
+        }
+    }
+    for (int j = 1; j < nbCols; j++) {
+        key ^= Table::getKey(colFeature | (uint64_t) m.getValue(0, j));
+    }
+
+    // Cost of the included segments, and the fragments they form
+    int size = this->initialMatrix.getNbRows();
+    vector<int> next(size, 0);
+    vector<bool> hasPrevious(size, false);
+    T cost = 0;
+    for (int index = id; index != 0; index = tree[index].parentNodeKey) {
+        if (!tree[index].bar) {
+            const pair<int, int> &segment = tree[index].path;
+            cost += this->initialMatrix.getValue(segment.first, segment.second);
+            next[segment.first] = segment.second;
+            hasPrevious[segment.second] = true;
+        }
+    }
+    for (int city = 1; city < size; city++) {
+        if (next[city] != 0 and !hasPrevious[city]) {
+            int end = city;
+            while (next[end] != 0) {
+                end = next[end];
+            }
+            key ^= Table::getKey(fragmentFeature | (uint64_t) city << 30 | end);
+        }
+    }
+    return this->transpositionTable->isDominated(key, cost);
+}
+
+// Return the constraints of the node id, its included and excluded segments
+template<class T> Subproblem<T> Little<T>::getSubproblem(int id) {
+    Subproblem<T> subproblem;
+    subproblem.bound = tree[id].cost;
+    while (id != 0) {
+        if (tree[id].bar) {
+            subproblem.excluded.push_back(tree[id].path);
+            if (tree[id].mirrorClosed) {
+                subproblem.excluded.push_back(std::make_pair(tree[id].path.second, tree[id].path.first));
+            }
+        }
+        else {
+            subproblem.included.push_back(tree[id].path);
+        }
+        id = tree[id].parentNodeKey;
+    }
+    std::reverse(subproblem.included.begin(), subproblem.included.end());
+    std::reverse(subproblem.excluded.begin(), subproblem.excluded.end());
+    return subproblem;
+}
+
+/*
+ * Restrict the search to the tours satisfying the constraints of a
+ * subproblem, found by split or given away by another search. With a
+ * shared bound, the search may end without any tour, when the tours of
+ * the subproblem are not better than the bound. Return false if the
+ * constraints are not valid segments of the problem
+ */
+template<class T> bool Little<T>::setConstraints(const Subproblem<T> &subproblem) {
+    int nbCities = this->initialMatrix.getNbRows() - 1;
+    vector<pair<int, int> > segments(subproblem.included);
+    segments.insert(segments.end(), subproblem.excluded.begin(), subproblem.excluded.end());
+    for (const pair<int, int> &segment : segments) {
+        if (segment.first < 1 or segment.first > nbCities or segment.second < 1 or segment.second > nbCities or
+                segment.first == segment.second) {
+            return false;
+        }
+    }
+    if (subproblem.included.size() > nbCities - 2) {
+        return false;
+    }
+    this->constraints = subproblem;
+    return true;
+}
+
+template<class T> const int Little<T>::maxKernelSize;
+
+/*
+ * Search the subproblems of at most the given number of cities with the
+ * fixed size kernels, 0 for none. Return false if the size exceeds the
+ * largest kernel
+ */
+template<class T> bool Little<T>::setKernelSize(int size) {
+    if (size < 0 or size > maxKernelSize) {
+        return false;
+    }
+    this->kernelSize = size;
+    return true;
+}
+
+/*
+ * Search only one of each tour and its reverse, for a symmetric problem.
+ * Return false, the problem being kept asymmetric, if the costs are not symmetric
+ */
+template<class T> bool Little<T>::setSymmetric(bool symmetric) {
+    int size = this->initialMatrix.getNbRows();
+    for (int i = 1; symmetric and i < size; i++) {
+        for (int j = 1; j < i; j++) {
+            if (this->initialMatrix.getValue(i, j) != this->initialMatrix.getValue(j, i)) {
+                this->symmetric = false;
+                return false;
+            }
+        }
+    }
+    this->symmetric = symmetric;
+    return true;
+}
+
+/*
+ * Split the search into the subproblems of the nodes at the given depth of
+ * the tree, or above when their matrix becomes small. The subproblems which
+ * cannot improve the reference are dropped, the others are sorted by bound
+ */
+template<class T> vector<Subproblem<T> > Little<T>::split(int depth) {
+    vector<Subproblem<T> > subproblems;
+    OpenNode<T> root;
+    root.id = 0;
+    root.matrix = this->initialMatrix;
+    Node<T> node;
+    node.cost = reduce(root.matrix, root.assignment);
+    node.mirrorClosed = this->symmetric;
+    tree.push_back(node);
+    splitNode(root, depth, Subproblem<T>(), subproblems);
+
+    std::stable_sort(subproblems.begin(), subproblems.end(),
+                     [](const Subproblem<T> &a, const Subproblem<T> &b) { return a.bound < b.bound; });
+    return subproblems;
+}
+
+// Branch on the reduced matrix of a node till the given depth
+template<class T> void Little<T>::splitNode(OpenNode<T> &node, int depth, const Subproblem<T> &constraints,
+                                            vector<Subproblem<T> > &subproblems) {
+    int id = node.id;
+    if (tree[id].cost >= this->reference or tree[id].cost >= this->infinity) {
+        return;
+    }
+    Matrix<T> &m = node.matrix;
+    if (depth == 0 or m.getNbRows() <= 4) {
+        subproblems.push_back(constraints);
+        subproblems.back().bound = tree[id].cost;
+        return;
+    }
+
+    Node<T> child;
+    pair<int, int> pos;
+    this->assignment = node.assignment;
+    calculateRegret(m, id, child.path, pos);
+
+    // Child excluding the segment, and its mirror when the node is mirror closed
+    OpenNode<T> excluded;
+    excluded.matrix = m;
+    excluded.matrix.setValue(pos.first, pos.second, this->infinity);
+    Subproblem<T> excludedConstraints(constraints);
+    excludedConstraints.excluded.push_back(child.path);
+    if (tree[id].mirrorClosed) {
+        excluded.matrix.setValue(child.path.second, child.path.first, this->infinity);
+        excludedConstraints.excluded.push_back(std::make_pair(child.path.second, child.path.first));
+    }
+    excluded.assignment = node.assignment;
+    child.bar = true;
+    child.mirrorClosed = tree[id].mirrorClosed;
+    child.cost = tree[id].cost + reduce(excluded.matrix, excluded.assignment);
+    child.parentNodeKey = id;
+    tree.push_back(child);
+    excluded.id = tree.size() - 1;
+    splitNode(excluded, depth - 1, excludedConstraints, subproblems);
+
+    // Child including the segment
+    m.removeRow(pos.first);
+    m.removeColumn(pos.second);
+    removeSubTour(m, id, child.path);
+    child.bar = false;
+    child.mirrorClosed = false;
+    child.cost = tree[id].cost + reduce(m, node.assignment);
+    tree.push_back(child);
+    node.id = tree.size() - 1;
+    Subproblem<T> includedConstraints(constraints);
+    includedConstraints.included.push_back(child.path);
+    splitNode(node, depth - 1, includedConstraints, subproblems);
+}
+
+// Lower the reference to the cost of a tour found elsewhere, if any
+template<class T> void Little<T>::pollSharedBound() {
+    if (this->sharedBound) {
+        T bound = this->sharedBound();
+        if (bound < this->reference) {
+            this->reference = bound;
+        }
+    }
+}
+
+// Poll the stop condition, once it has been met the search stays stopped
+template<class T> bool Little<T>::mustStop() {
+    if (!this->stopped and this->stopCondition and this->stopCondition()) {
+        this->stopped = true;
+    }
+    return this->stopped;
+}
+
 // Add the two last segments of the tour when the matrix is 2x2
 template<class T> void Little<T>::addLastPath(Matrix<T> &m) {
     Node<T> normalNode;
@@ -364,14 +1073,94 @@ template<class T> void Little<T>::addLastPath(Matrix<T> &m) {
     }
 }
 
-template<class T> Little<T>::Little(Matrix<T> &m) {
-#ifdef DEBUG
-//    cout << m << endl;
-#endif
-
+template<class T> Little<T>::Little(const Matrix<T> &m) : branchingRule(std::make_shared<RegretRule<T> >()) {
     this->infinity = m.getEmptyValue();     // Retrieval of the emptyValue, that we consider as infinity
-    addIndices(m);      // Addition of the indexes in the matrix
     this->initialMatrix = m;    // storage of the initial matrix
+    addIndices(this->initialMatrix);    // Addition of the indexes in the matrix
+}
+
+// Build a symmetric problem, searched without the reverse of the tours. The search needs the full matrix, m is expanded
+template<class T> Little<T>::Little(const SymmetricMatrix<T> &m) : branchingRule(std::make_shared<RegretRule<T> >()) {
+    this->infinity = m.getEmptyValue();
+    int size = m.getNbRows();
+    this->initialMatrix = Matrix<T>(size + 1, size + 1, this->infinity);
+    for (int i = 0; i <= size; i++) {
+        this->initialMatrix.setValue(0, i, i);
+        this->initialMatrix.setValue(i, 0, i);
+    }
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < i; j++) {
+            this->initialMatrix.setValue(i + 1, j + 1, m.getValue(i, j));
+            this->initialMatrix.setValue(j + 1, i + 1, m.getValue(i, j));
+        }
+    }
+    this->symmetric = true;
+}
+
+/*
+ * Build the problem from a row-major buffer of size x size costs,
+ * which is neither kept nor modified. The diagonal is ignored
+ */
+template<class T> Little<T>::Little(const T *costs, int size, T infinity)
+        : branchingRule(std::make_shared<RegretRule<T> >()) {
+    this->infinity = infinity;
+    this->initialMatrix = Matrix<T>(size + 1, size + 1, infinity);
+    for (int i = 0; i <= size; i++) {
+        this->initialMatrix.setValue(0, i, i);
+        this->initialMatrix.setValue(i, 0, i);
+    }
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if (i != j) {
+                this->initialMatrix.setValue(i + 1, j + 1, costs[i * size + j]);
+            }
+        }
+    }
+}
+
+// Return the cost of a tour in the initial matrix
+template<class T> T Little<T>::getTourCost(const vector<int> &tour) {
+    T cost = 0;
+    int size = tour.size();
+    for (int i = 0; i < size - 1; i++) {
+        cost += this->initialMatrix.getValue(tour[i], tour[i + 1]);
+    }
+    cost += this->initialMatrix.getValue(tour.back(), tour.front());
+    return cost;
+}
+
+/*
+ * Install a known tour as the incumbent, so that the search only explores
+ * the branches able to improve it. Return false if the tour is not valid
+ */
+template<class T> bool Little<T>::setInitialTour(const vector<int> &tour) {
+    int nbCities = this->initialMatrix.getNbRows() - 1;
+    if (tour.size() != nbCities) {
+        return false;
+    }
+    vector<bool> visited(nbCities + 1, false);
+    for (int city : tour) {
+        if (city < 1 or city > nbCities or visited[city]) {
+            return false;
+        }
+        visited[city] = true;
+    }
+    for (int i = 0; i < nbCities; i++) {
+        if (this->initialMatrix.getValue(tour[i], tour[(i + 1) % nbCities]) == this->infinity) {
+            return false;
+        }
+    }
+
+    // Rotation of the tour so that it starts by the city 1, like the found ones
+    vector<int> rotated(tour);
+    std::rotate(rotated.begin(), std::find(rotated.begin(), rotated.end(), 1), rotated.end());
+
+    T cost = getTourCost(rotated);
+    if (cost < this->reference) {
+        this->reference = cost;
+        this->lastTour = rotated;
+    }
+    return true;
 }
 
 #ifdef DEBUG
@@ -380,13 +1169,7 @@ template<class T> Little<T>::Little(Matrix<T> &m) {
  * Useful to verify that the cost stored in the nodes is correct
  */
 template<class T> void Little<T>::checkTourCost() {
-    int cost = 0;
-    int size = this->lastTour.size();
-    for (int i = 0; i < size - 1; i++) {
-        cost += this->initialMatrix.getValue(this->lastTour[i], this->lastTour[i + 1]);
-    }
-    cost += this->initialMatrix.getValue(this->lastTour.back(), this->lastTour.front());
-    cout << "Cost check " << cost << " ";
+    cout << "Cost check " << getTourCost(this->lastTour) << " ";
 }
 #endif
 
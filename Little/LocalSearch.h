@@ -0,0 +1,118 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+// Tour heuristics shared by Reoptimizer and Decomposer, on a matrix without indexes, cities numbered from 1
+
+#include "../Matrix/Matrix.h"
+#include <algorithm>
+
+/*
+ * Return the nearest neighbour tour from the city start (numbered from 0).
+ * The city last, if any, is kept for the end of the tour
+ */
+template<class T> vector<int> nearestNeighbour(const Matrix<T> &m, int start, int last = -1) {
+    int size = m.getNbRows();
+    vector<bool> visited(size, false);
+    vector<int> tour(1, start + 1);
+    visited[start] = true;
+    if (last >= 0) {
+        visited[last] = true;
+    }
+    while (tour.size() < size - (last >= 0 and last != start ? 1 : 0)) {
+        int from = tour.back() - 1;
+        int next = -1;
+        for (int j = 0; j < size; j++) {
+            if (!visited[j] and (next < 0 or m.getValue(from, j) < m.getValue(from, next))) {
+                next = j;
+            }
+        }
+        visited[next] = true;
+        tour.push_back(next + 1);
+    }
+    if (last >= 0 and last != start) {
+        tour.push_back(last + 1);
+    }
+    return tour;
+}
+
+// 2-opt : reverse the parts of the tour while it decreases the cost, symmetric problems only
+template<class T> void twoOpt(const Matrix<T> &m, vector<int> &tour) {
+    T infinity = m.getEmptyValue();
+    int size = tour.size();
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int i = 0; i < size - 2; i++) {
+            int a = tour[i], b = tour[i + 1];
+            T removed = m.getValue(a - 1, b - 1);
+            for (int j = i + 2; j < size - (i == 0 ? 1 : 0); j++) {
+                int c = tour[j], d = tour[(j + 1) % size];
+                T first = m.getValue(a - 1, c - 1);
+                T second = m.getValue(b - 1, d - 1);
+                if (first == infinity or second == infinity) {
+                    continue;
+                }
+                if (first + second < removed + m.getValue(c - 1, d - 1)) {
+                    std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                    b = tour[i + 1];
+                    removed = m.getValue(a - 1, b - 1);
+                    improved = true;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Or-opt : move chains of 1 to 3 cities elsewhere in the tour while it
+ * decreases the cost. The orientation of the chains is kept, so that it
+ * also applies to asymmetric problems
+ */
+template<class T> void orOpt(const Matrix<T> &m, vector<int> &tour) {
+    T infinity = m.getEmptyValue();
+    int size = tour.size();
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (int length = 1; length <= 3 and length < size - 2; length++) {
+            for (int i = 0; i < size; i++) {
+                int previous = tour[(i + size - 1) % size];
+                int first = tour[i];
+                int last = tour[(i + length - 1) % size];
+                int next = tour[(i + length) % size];
+                if (m.getValue(previous - 1, next - 1) == infinity) {
+                    continue;
+                }
+                T removalGain = m.getValue(previous - 1, first - 1) + m.getValue(last - 1, next - 1) -
+                                m.getValue(previous - 1, next - 1);
+
+                // Segments of the tour which do not touch the chain
+                for (int j = i + length; j < i + size - 1; j++) {
+                    int from = tour[j % size];
+                    int to = tour[(j + 1) % size];
+                    if (m.getValue(from - 1, first - 1) == infinity or m.getValue(last - 1, to - 1) == infinity) {
+                        continue;
+                    }
+                    T insertionCost = m.getValue(from - 1, first - 1) + m.getValue(last - 1, to - 1) -
+                                      m.getValue(from - 1, to - 1);
+                    if (insertionCost < removalGain) {
+                        vector<int> moved;
+                        for (int k = i + length; k < i + size; k++) {
+                            moved.push_back(tour[k % size]);
+                            if (tour[k % size] == from) {
+                                for (int l = 0; l < length; l++) {
+                                    moved.push_back(tour[(i + l) % size]);
+                                }
+                            }
+                        }
+                        tour = moved;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif  /* LOCALSEARCH_H */
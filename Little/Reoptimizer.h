@@ -0,0 +1,160 @@
+#ifndef REOPTIMIZER_H
+#define REOPTIMIZER_H
+
+#include "Little.h"
+#include "LocalSearch.h"
+
+/*
+ * Re-optimization of a solved problem after a few edits of its matrix.
+ * The previous tour is repaired and improved by a local search, then used
+ * as the incumbent of a Little search bounded in number of nodes
+ */
+template<class T>
+class Reoptimizer {
+private:
+    Matrix<T> matrix;           // current problem, without the indexes
+    vector<int> tour;           // current tour, cities numbered from 1
+    bool optimal;               // current tour proven optimal or not
+    bool tourKept;              // edits unable to make another tour better than the previous one
+    long nbNodes = 0;           // nodes explored by the last search
+    T getSegmentCost(int from, int to) { return this->matrix.getValue(from - 1, to - 1); }
+    bool isTourSegment(int from, int to);
+
+public:
+    Reoptimizer(const Matrix<T> &m, const vector<int> &tour, bool optimal = true);
+    void setCost(int from, int to, T value);
+    void setSymmetricCost(int from, int to, T value);
+    void addCity(const vector<T> &costsFrom, const vector<T> &costsTo);
+    void removeCity(int city);
+    void reoptimize(long nodeLimit = 0);
+    Matrix<T> getMatrix() { return this->matrix; }      // Return the edited matrix
+    vector<int> getTour() { return this->tour; }        // Return the current tour
+    T getCost();
+    bool isOptimal() { return this->optimal; }          // Return whether the tour is proven optimal
+    long getNbNodes() { return this->nbNodes; }         // Return the nodes explored by the last search
+};
+
+template<class T> Reoptimizer<T>::Reoptimizer(const Matrix<T> &m, const vector<int> &tour, bool optimal)
+        : matrix(m), tour(tour), optimal(optimal), tourKept(true) {
+}
+
+// Return whether the segment from -> to belongs to the current tour
+template<class T> bool Reoptimizer<T>::isTourSegment(int from, int to) {
+    int size = this->tour.size();
+    for (int i = 0; i < size; i++) {
+        if (this->tour[i] == from) {
+            return this->tour[(i + 1) % size] == to;
+        }
+    }
+    return false;
+}
+
+// Return the cost of the current tour
+template<class T> T Reoptimizer<T>::getCost() {
+    T cost = 0;
+    int size = this->tour.size();
+    for (int i = 0; i < size; i++) {
+        cost += getSegmentCost(this->tour[i], this->tour[(i + 1) % size]);
+    }
+    return cost;
+}
+
+/*
+ * Change the cost of a segment. The previous tour stays optimal as long as
+ * the segments of the tour only get cheaper and the other ones more expensive
+ */
+template<class T> void Reoptimizer<T>::setCost(int from, int to, T value) {
+    T previous = getSegmentCost(from, to);
+    bool inTour = isTourSegment(from, to);
+    if ((value > previous and inTour) or (value < previous and !inTour)) {
+        this->tourKept = false;
+    }
+    this->matrix.setValue(from - 1, to - 1, value);
+}
+
+/*
+ * Change the cost of a segment and of its reverse, for a symmetric problem :
+ * the segment belongs to the tour whatever the direction it is travelled in
+ */
+template<class T> void Reoptimizer<T>::setSymmetricCost(int from, int to, T value) {
+    T previous = getSegmentCost(from, to);
+    bool inTour = isTourSegment(from, to) or isTourSegment(to, from);
+    if ((value > previous and inTour) or (value < previous and !inTour)) {
+        this->tourKept = false;
+    }
+    this->matrix.setValue(from - 1, to - 1, value);
+    this->matrix.setValue(to - 1, from - 1, value);
+}
+
+/*
+ * Add a city numbered n + 1, given its costs to and from the existing cities,
+ * it is inserted in the tour where it is the cheapest
+ */
+template<class T> void Reoptimizer<T>::addCity(const vector<T> &costsFrom, const vector<T> &costsTo) {
+    int size = this->matrix.getNbRows();
+    this->matrix.addRow(size);
+    this->matrix.addColumn(size);
+    for (int i = 0; i < size; i++) {
+        this->matrix.setValue(size, i, costsFrom[i]);
+        this->matrix.setValue(i, size, costsTo[i]);
+    }
+
+    int city = size + 1;
+    int bestPosition = 0;
+    T bestCost = std::numeric_limits<T>::max();
+    for (int i = 0; i < size; i++) {
+        int from = this->tour[i];
+        int to = this->tour[(i + 1) % size];
+        T insertionCost = getSegmentCost(from, city) + getSegmentCost(city, to) - getSegmentCost(from, to);
+        if (insertionCost < bestCost) {
+            bestCost = insertionCost;
+            bestPosition = i + 1;
+        }
+    }
+    this->tour.insert(this->tour.begin() + bestPosition, city);
+    this->tourKept = false;
+}
+
+// Remove a city, the next cities are renumbered and the tour is shortcut
+template<class T> void Reoptimizer<T>::removeCity(int city) {
+    this->matrix.removeRow(city - 1);
+    this->matrix.removeColumn(city - 1);
+    this->tour.erase(std::find(this->tour.begin(), this->tour.end(), city));
+    for (int &c : this->tour) {
+        if (c > city) {
+            c--;
+        }
+    }
+    this->tourKept = false;
+}
+
+/*
+ * Find the new optimal tour. Nothing is searched when the edits keep the
+ * previous optimal tour, otherwise the search stops after nodeLimit nodes
+ * (0 for no limit) and isOptimal tells whether the optimality is re-proven
+ */
+template<class T> void Reoptimizer<T>::reoptimize(long nodeLimit) {
+    this->nbNodes = 0;
+    if (this->tourKept and this->optimal) {
+        return;
+    }
+
+    orOpt(this->matrix, this->tour);
+    std::rotate(this->tour.begin(), std::find(this->tour.begin(), this->tour.end(), 1), this->tour.end());
+
+    Little<T> little(this->matrix);
+    little.setInitialTour(this->tour);
+    if (nodeLimit > 0) {
+        little.setStopCondition([&little, nodeLimit]() { return little.getNbNodes() >= nodeLimit; });
+    }
+    little.findTour();
+
+    if (!little.getLastTour().empty()) {
+        this->tour = little.getLastTour();
+    }
+    this->optimal = little.isOptimal();
+    this->nbNodes = little.getNbNodes();
+    this->tourKept = true;
+}
+
+#endif  /* REOPTIMIZER_H */
@@ -0,0 +1,231 @@
+#ifndef SPILLFILE_H
+#define SPILLFILE_H
+
+// Included by Little.h, stores the open nodes which do not fit in the memory limit
+
+#include "../Matrix/Matrix.h"
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+template<class T> struct OpenNode;
+
+/*
+ * Temporary file holding open nodes. The nodes are written by batches,
+ * appended to the file by a writer thread while the search goes on,
+ * and read back one by one from the smallest bound
+ */
+template<class T>
+class SpillFile {
+private:
+    // Position of a written node
+    struct Record {
+        T bound;
+        long offset;
+        size_t size;
+        bool operator<(const Record &other) const { return this->bound > other.bound; }     // smallest bound first
+    };
+
+    T infinity;                             // empty value of the read matrices
+    FILE *file;
+    long fileSize = 0;                      // bytes written or waiting to be written
+    std::priority_queue<Record> records;    // written nodes not read back yet
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<vector<char> > pending;      // batches waiting for the writer thread
+    bool writing = false;                   // batch being written
+    bool closing = false;
+    bool failed = false;                    // a batch could not be written
+
+    long nbWritten = 0;
+    long nbRead = 0;
+    long nbPruned = 0;                      // nodes dropped without being read, their bound exceeding the reference
+    long long bytesWritten = 0;
+    long long bytesRead = 0;
+    double writeSeconds = 0;
+    double readSeconds = 0;
+
+    void writeBatches();
+    void waitWrites();
+
+public:
+    SpillFile(T infinity);
+    ~SpillFile();
+    bool isOpen() { return this->file != nullptr; }
+    bool hasFailed();
+    bool empty() { return this->records.empty(); }
+    void write(const vector<OpenNode<T> > &nodes, const vector<T> &bounds);
+    bool read(OpenNode<T> &node, T reference);
+    long getNbWritten() { return this->nbWritten; }
+    long getNbRead() { return this->nbRead; }
+    long getNbPruned() { return this->nbPruned; }
+    long long getBytesWritten() { return this->bytesWritten; }
+    long long getBytesRead() { return this->bytesRead; }
+    double getWriteSeconds() { return this->writeSeconds; }     // time spent by the writer thread
+    double getReadSeconds() { return this->readSeconds; }
+};
+
+// The file is removed once closed
+template<class T> SpillFile<T>::SpillFile(T infinity) : infinity(infinity), file(std::tmpfile()) {
+    if (this->file) {
+        this->writer = std::thread(&SpillFile<T>::writeBatches, this);
+    }
+}
+
+template<class T> SpillFile<T>::~SpillFile() {
+    if (this->file) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closing = true;
+        }
+        this->condition.notify_all();
+        this->writer.join();
+        std::fclose(this->file);
+    }
+}
+
+// Writer thread, append the pending batches to the file
+template<class T> void SpillFile<T>::writeBatches() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->condition.wait(lock, [this]() { return this->closing or !this->pending.empty(); });
+        if (this->pending.empty()) {
+            return;
+        }
+        vector<char> batch;
+        batch.swap(this->pending.front());
+        this->pending.pop_front();
+        this->writing = true;
+        lock.unlock();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool written = std::fseek(this->file, 0, SEEK_END) == 0 and
+                       std::fwrite(batch.data(), 1, batch.size(), this->file) == batch.size();
+        double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        this->writing = false;
+        this->writeSeconds += duration;
+        if (!written) {
+            this->failed = true;
+        }
+        this->condition.notify_all();
+    }
+}
+
+// Wait for the writer thread to write all the pending batches
+template<class T> void SpillFile<T>::waitWrites() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this]() { return this->pending.empty() and !this->writing; });
+}
+
+// Return whether a batch could not be written, its nodes are then lost
+template<class T> bool SpillFile<T>::hasFailed() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->failed;
+}
+
+/*
+ * Queue the nodes to be written, with their bounds. A node is stored as its
+ * id, its matrix dimensions and its assignment size, then its values
+ */
+template<class T> void SpillFile<T>::write(const vector<OpenNode<T> > &nodes, const vector<T> &bounds) {
+    size_t batchSize = 0;
+    for (const OpenNode<T> &node : nodes) {
+        batchSize += 4 * sizeof(int) + node.matrix.getNbRows() * node.matrix.getNbColumns() * sizeof(T) +
+                     node.assignment.size() * sizeof(int);
+    }
+    vector<char> batch(batchSize);
+    char *position = batch.data();
+    for (int k = 0; k < nodes.size(); k++) {
+        const OpenNode<T> &node = nodes[k];
+        int header[4] = {node.id, node.matrix.getNbRows(), node.matrix.getNbColumns(), (int) node.assignment.size()};
+        std::memcpy(position, header, sizeof(header));
+        char *begin = position;
+        position += sizeof(header);
+        for (int i = 0; i < header[1]; i++) {
+            for (int j = 0; j < header[2]; j++) {
+                T value = node.matrix.getValue(i, j);
+                std::memcpy(position, &value, sizeof(T));
+                position += sizeof(T);
+            }
+        }
+        std::memcpy(position, node.assignment.data(), node.assignment.size() * sizeof(int));
+        position += node.assignment.size() * sizeof(int);
+
+        Record record;
+        record.bound = bounds[k];
+        record.offset = this->fileSize + (begin - batch.data());
+        record.size = position - begin;
+        this->records.push(record);
+    }
+    this->fileSize += batchSize;
+    this->nbWritten += nodes.size();
+    this->bytesWritten += batchSize;
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pending.push_back(vector<char>());
+        this->pending.back().swap(batch);
+    }
+    this->condition.notify_all();
+}
+
+/*
+ * Read back the node of the smallest bound, the nodes whose bound is not
+ * below the reference are dropped. Return false if there is no such node
+ */
+template<class T> bool SpillFile<T>::read(OpenNode<T> &node, T reference) {
+    while (!this->records.empty() and this->records.top().bound >= reference) {
+        this->records.pop();
+        this->nbPruned++;
+    }
+    if (this->records.empty()) {
+        return false;
+    }
+    waitWrites();
+    if (this->failed) {
+        return false;
+    }
+    Record record = this->records.top();
+    this->records.pop();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vector<char> buffer(record.size);
+    if (std::fseek(this->file, record.offset, SEEK_SET) != 0 or
+            std::fread(buffer.data(), 1, record.size, this->file) != record.size) {
+        this->failed = true;
+        return false;
+    }
+    this->readSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int header[4];
+    const char *position = buffer.data();
+    std::memcpy(header, position, sizeof(header));
+    position += sizeof(header);
+    node.id = header[0];
+    node.matrix = Matrix<T>(header[1], header[2], this->infinity);
+    for (int i = 0; i < header[1]; i++) {
+        for (int j = 0; j < header[2]; j++) {
+            T value;
+            std::memcpy(&value, position, sizeof(T));
+            node.matrix.setValue(i, j, value);
+            position += sizeof(T);
+        }
+    }
+    node.assignment.resize(header[3]);
+    std::memcpy(node.assignment.data(), position, header[3] * sizeof(int));
+
+    this->nbRead++;
+    this->bytesRead += record.size;
+    return true;
+}
+
+#endif  /* SPILLFILE_H */
@@ -0,0 +1,119 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+// Included by Little.h, detects the subproblems reached again by another branch order
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+ * Bounded hash table of the subproblems met by the search. A subproblem is
+ * keyed by the hash of its remaining cities, its path fragments and its
+ * forbidden segments, the XOR of one pseudo random key per feature. Each
+ * entry holds the smallest cost of the included segments that reached it :
+ * a later arrival with a larger cost is dominated, its completions being the
+ * same. The table is lock-free, so that it can be shared by several searches
+ * of the same problem : a torn entry does not match its key and is ignored
+ */
+template<class T>
+class TranspositionTable {
+private:
+    // The key is stored XOR the data, a torn entry thus does not match
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t mask;                          // number of entries - 1, a power of 2
+
+    std::atomic<long> nbLookups;
+    std::atomic<long> nbHits;               // lookups finding their subproblem
+    std::atomic<long> nbPruned;             // hits dominated by the stored cost
+    std::atomic<long> nbStored;
+    std::atomic<long> nbEvictions;          // entries replaced by another subproblem
+
+    static uint64_t encode(T cost);
+    static T decode(uint64_t data);
+
+public:
+    TranspositionTable(size_t bytes);
+    bool isDominated(uint64_t key, T cost);
+    size_t getNbEntries() { return this->entries.size(); }
+    long getNbLookups() { return this->nbLookups.load(); }
+    long getNbHits() { return this->nbHits.load(); }
+    long getNbPruned() { return this->nbPruned.load(); }
+    long getNbStored() { return this->nbStored.load(); }
+    long getNbEvictions() { return this->nbEvictions.load(); }
+
+    // Return the key of a feature of a subproblem, mixed by splitmix64
+    static uint64_t getKey(uint64_t feature) {
+        uint64_t z = feature + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// The number of entries is the largest power of 2 fitting in the given bytes, at least 1
+template<class T> TranspositionTable<T>::TranspositionTable(size_t bytes)
+        : nbLookups(0), nbHits(0), nbPruned(0), nbStored(0), nbEvictions(0) {
+    size_t size = 1;
+    while (size * 2 * sizeof(Entry) <= bytes) {
+        size *= 2;
+    }
+    this->entries = std::vector<Entry>(size);
+    for (Entry &entry : this->entries) {
+        entry.check.store(0, std::memory_order_relaxed);
+        entry.data.store(0, std::memory_order_relaxed);
+    }
+    this->mask = size - 1;
+}
+
+template<class T> uint64_t TranspositionTable<T>::encode(T cost) {
+    static_assert(sizeof(T) <= sizeof(uint64_t), "the costs must fit in 64 bits");
+    uint64_t data = 0;
+    std::memcpy(&data, &cost, sizeof(T));
+    return data;
+}
+
+template<class T> T TranspositionTable<T>::decode(uint64_t data) {
+    T cost;
+    std::memcpy(&cost, &data, sizeof(T));
+    return cost;
+}
+
+/*
+ * Return whether the subproblem has already been reached with included
+ * segments costing at most the given cost, otherwise store this cost.
+ * The key 0 is kept for the empty entries
+ */
+template<class T> bool TranspositionTable<T>::isDominated(uint64_t key, T cost) {
+    if (key == 0) {
+        key = 1;
+    }
+    this->nbLookups.fetch_add(1, std::memory_order_relaxed);
+    Entry &entry = this->entries[key & this->mask];
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == key) {
+        this->nbHits.fetch_add(1, std::memory_order_relaxed);
+        if (decode(data) <= cost) {
+            this->nbPruned.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    else if (check != 0) {
+        this->nbEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    data = encode(cost);
+    entry.data.store(data, std::memory_order_relaxed);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    this->nbStored.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+#endif  /* TRANSPOSITIONTABLE_H */
@@ -22,17 +22,17 @@ private:
 public:
     Matrix(int nbRows = 0, int nbColumns = 0, T emptyValue = 0) throw(NegativeDimensionException);
 
-    T getEmptyValue() { return this->emptyVal; }
+    T getEmptyValue() const { return this->emptyVal; }
 
-    int getNbRows() { return this->row; }
+    int getNbRows() const { return this->row; }
     void addRow(int rowIndex) throw(IndexOutOfBoundsException);
     void removeRow(int rowIndex) throw(IndexOutOfBoundsException);
 
-    int getNbColumns() { return this->col; }
+    int getNbColumns() const { return this->col; }
     void addColumn(int colIndex) throw(IndexOutOfBoundsException);
     void removeColumn(int colIndex) throw(IndexOutOfBoundsException);
 
-    T getValue(int rowIndex, int colIndex) throw(IndexOutOfBoundsException);
+    T getValue(int rowIndex, int colIndex) const throw(IndexOutOfBoundsException);
     void setValue(int rowIndex, int colIndex, T value) throw(IndexOutOfBoundsException);
 
     ~Matrix();
@@ -111,7 +111,7 @@ template <class T> void Matrix<T>::removeColumn(int colIndex) throw(IndexOutOfBo
     this->col--;
 }
 
-template <class T> T Matrix<T>::getValue(int rowIndex, int colIndex) throw(IndexOutOfBoundsException) {
+template <class T> T Matrix<T>::getValue(int rowIndex, int colIndex) const throw(IndexOutOfBoundsException) {
     if (rowIndex < 0 or rowIndex >= this->row) {
         throw IndexOutOfBoundsException(rowIndex, 0, this->row - 1);
     }
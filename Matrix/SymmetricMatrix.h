@@ -0,0 +1,81 @@
+#ifndef SYMMETRICMATRIX_H
+#define	SYMMETRICMATRIX_H
+
+#include "Matrix.h"
+#include <utility>
+
+/*
+ * Square matrix equal to its transpose : only the cells below the diagonal
+ * are stored, packed row after row, the diagonal holds the empty value
+ */
+template<class T> class SymmetricMatrix {
+private:
+    int size;
+    T emptyVal;
+    vector<T> data;     // cell i j, with j < i, at i * (i - 1) / 2 + j
+
+public:
+    SymmetricMatrix(int size = 0, T emptyValue = 0) throw(NegativeDimensionException);
+
+    T getEmptyValue() const { return this->emptyVal; }
+    int getNbRows() const { return this->size; }
+    int getNbColumns() const { return this->size; }
+
+    T getValue(int rowIndex, int colIndex) const throw(IndexOutOfBoundsException);
+    void setValue(int rowIndex, int colIndex, T value) throw(IndexOutOfBoundsException);
+    Matrix<T> toMatrix() const;
+};
+
+template <class T> SymmetricMatrix<T>::SymmetricMatrix(int size, T emptyValue) throw(NegativeDimensionException) {
+    if (size < 0) {
+        throw NegativeDimensionException();
+    }
+    this->data = vector<T>((size_t) size * (size - 1) / 2, emptyValue);
+    this->size = size;
+    this->emptyVal = emptyValue;
+}
+
+template <class T> T SymmetricMatrix<T>::getValue(int rowIndex, int colIndex) const throw(IndexOutOfBoundsException) {
+    if (rowIndex < 0 or rowIndex >= this->size) {
+        throw IndexOutOfBoundsException(rowIndex, 0, this->size - 1);
+    }
+    if (colIndex < 0 or colIndex >= this->size) {
+        throw IndexOutOfBoundsException(colIndex, 0, this->size - 1);
+    }
+    if (rowIndex == colIndex) {
+        return this->emptyVal;
+    }
+    if (rowIndex < colIndex) {
+        std::swap(rowIndex, colIndex);
+    }
+    return this->data[(size_t) rowIndex * (rowIndex - 1) / 2 + colIndex];
+}
+
+// Set both the cell and its mirror, the diagonal cannot be set
+template <class T> void SymmetricMatrix<T>::setValue(int rowIndex, int colIndex, T value) throw(IndexOutOfBoundsException) {
+    if (rowIndex < 0 or rowIndex >= this->size) {
+        throw IndexOutOfBoundsException(rowIndex, 0, this->size - 1);
+    }
+    if (colIndex < 0 or colIndex >= this->size or colIndex == rowIndex) {
+        throw IndexOutOfBoundsException(colIndex, 0, this->size - 1);
+    }
+    if (rowIndex < colIndex) {
+        std::swap(rowIndex, colIndex);
+    }
+    this->data[(size_t) rowIndex * (rowIndex - 1) / 2 + colIndex] = value;
+}
+
+// Return the full matrix
+template <class T> Matrix<T> SymmetricMatrix<T>::toMatrix() const {
+    Matrix<T> m(this->size, this->size, this->emptyVal);
+    for (int i = 0; i < this->size; i++) {
+        for (int j = 0; j < i; j++) {
+            T value = this->data[(size_t) i * (i - 1) / 2 + j];
+            m.setValue(i, j, value);
+            m.setValue(j, i, value);
+        }
+    }
+    return m;
+}
+
+#endif	/* SYMMETRICMATRIX_H */
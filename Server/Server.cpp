@@ -0,0 +1,414 @@
+#include "Server.h"
+#include "../TSPLIB/tsplib.h"
+#include "../Little/Little.h"
+#include "../Cache/ResultCache.h"
+#include <sstream>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+using std::cout;
+using std::endl;
+using std::istringstream;
+using std::ostringstream;
+using std::make_shared;
+
+Connection::~Connection() {
+    close(this->fd);
+}
+
+/*
+ * Read a line from the client, without its end of line, return false once
+ * the client is gone or once a line exceeds maxLineLength. The connection
+ * is marked as closed once the client has closed it
+ */
+bool Connection::readLine(string &line) {
+    size_t end;
+    while ((end = this->buffer.find('\n')) == string::npos) {
+        if (this->buffer.size() > maxLineLength) {
+            this->lineTooLong = true;
+            return false;
+        }
+        char chunk[65536];
+        ssize_t received = recv(this->fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            this->closed = true;
+            return false;
+        }
+        this->buffer.append(chunk, received);
+    }
+    line = this->buffer.substr(0, end);
+    this->buffer.erase(0, end + 1);
+    if (!line.empty() and line.back() == '\r') {
+        line.pop_back();
+    }
+    return true;
+}
+
+// Read exactly count bytes from the client, return false once the client is gone, as readLine
+bool Connection::readBytes(size_t count, string &bytes) {
+    while (this->buffer.size() < count) {
+        char chunk[65536];
+        ssize_t received = recv(this->fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            this->closed = true;
+            return false;
+        }
+        this->buffer.append(chunk, received);
+    }
+    bytes = this->buffer.substr(0, count);
+    this->buffer.erase(0, count);
+    return true;
+}
+
+// Send a reply line, the connection is marked as closed if the client is gone
+void Connection::send(const string &message) {
+    std::lock_guard<std::mutex> lock(this->writeMutex);
+    string data = message + "\n";
+    size_t sent = 0;
+    while (!this->closed and sent < data.size()) {
+        ssize_t result = ::send(this->fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result <= 0) {
+            this->closed = true;
+        }
+        else {
+            sent += result;
+        }
+    }
+}
+
+// Stop both directions, a blocked readLine returns false
+void Connection::shutdown() {
+    ::shutdown(this->fd, SHUT_RDWR);
+}
+
+// Register a running request, return its cancellation flag or nullptr if the id is already running
+shared_ptr<std::atomic<bool> > Connection::addJob(const string &id) {
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    if (this->cancelFlags.count(id)) {
+        return nullptr;
+    }
+    shared_ptr<std::atomic<bool> > flag = make_shared<std::atomic<bool> >(false);
+    this->cancelFlags[id] = flag;
+    return flag;
+}
+
+void Connection::removeJob(const string &id) {
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    this->cancelFlags.erase(id);
+}
+
+// Raise the cancellation flag of a request, return false if it is unknown
+bool Connection::cancelJob(const string &id) {
+    std::lock_guard<std::mutex> lock(this->jobsMutex);
+    if (!this->cancelFlags.count(id)) {
+        return false;
+    }
+    *this->cancelFlags[id] = true;
+    return true;
+}
+
+Server::Server(string socketPath, int nbWorkers, size_t cacheCapacity)
+        : socketPath(socketPath), nbWorkers(nbWorkers), cacheCapacity(cacheCapacity) {
+    if (this->nbWorkers <= 0) {
+        this->nbWorkers = std::thread::hardware_concurrency();
+    }
+    if (this->nbWorkers <= 0) {
+        this->nbWorkers = 1;
+    }
+}
+
+// Start the worker pool and accept clients until a fatal error, return false on error
+bool Server::run() {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cout << "Error : Socket cannot be created" << endl;
+        return false;
+    }
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (this->socketPath.size() >= sizeof(address.sun_path)) {
+        cout << "Error : Socket path too long" << endl;
+        close(listener);
+        return false;
+    }
+    strcpy(address.sun_path, this->socketPath.c_str());
+
+    // Only a socket left by a previous run is replaced
+    struct stat status;
+    if (lstat(this->socketPath.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            cout << "Error : " << this->socketPath << " exists and is not a socket" << endl;
+            close(listener);
+            return false;
+        }
+        unlink(this->socketPath.c_str());
+    }
+
+    if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 or listen(listener, 64) < 0) {
+        cout << "Error : Socket " << this->socketPath << " cannot be bound" << endl;
+        close(listener);
+        return false;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < this->nbWorkers; i++) {
+        std::thread(&Server::worker, this).detach();
+    }
+    cout << "Listening on " << this->socketPath << " with " << this->nbWorkers << " workers" << endl;
+
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cout << "Error : Connection cannot be accepted" << endl;
+            close(listener);
+            return false;
+        }
+        std::thread(&Server::serve, this, make_shared<Connection>(client)).detach();
+    }
+}
+
+// Read the requests of a client and queue them for the workers
+void Server::serve(shared_ptr<Connection> connection) {
+    string line;
+    while (connection->readLine(line)) {
+        istringstream request(line);
+        string command, id;
+        request >> command >> id;
+        if (command.empty()) {
+            continue;
+        }
+        if (id.empty()) {
+            connection->send("ERROR - missing request id");
+            continue;
+        }
+
+        if (command == "CANCEL") {
+            if (!connection->cancelJob(id)) {
+                connection->send("ERROR " + id + " unknown request");
+            }
+            continue;
+        }
+
+        Job job;
+        int dimension = 0;
+        string content;
+        if (command == "SOLVE") {
+            // The problem goes till its EOF line
+            string problemLine;
+            bool complete = false;
+            while (!complete and connection->readLine(problemLine)) {
+                content += problemLine + "\n";
+                complete = (problemLine == "EOF");
+                if (problemLine.compare(0, 9, "DIMENSION") == 0) {
+                    size_t colon = problemLine.find(':');
+                    long value = colon == string::npos ? 0 : std::atol(problemLine.c_str() + colon + 1);
+                    if (value > maxDimension) {
+                        connection->send("ERROR " + id + " invalid dimension");
+                        return;
+                    }
+                }
+                if (content.size() > maxRequestSize) {
+                    connection->send("ERROR " + id + " problem too large");
+                    return;
+                }
+            }
+            if (!complete) {
+                if (connection->isLineTooLong()) {
+                    connection->send("ERROR " + id + " line too long");
+                }
+                return;
+            }
+        }
+        else if (command == "SOLVEBIN") {
+            if (!(request >> dimension) or dimension < 3 or dimension > maxDimension) {
+                connection->send("ERROR " + id + " invalid dimension");
+                return;
+            }
+            if (!connection->readBytes((size_t) dimension * dimension * sizeof(int32_t), content)) {
+                return;
+            }
+        }
+        else {
+            connection->send("ERROR " + id + " unknown command " + command);
+            continue;
+        }
+
+        long deadline;
+        if (request >> deadline) {
+            job.hasDeadline = true;
+            job.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(deadline);
+        }
+
+        string error;
+        job.instance = getInstance(command, dimension, content, error);
+        if (!job.instance) {
+            connection->send("ERROR " + id + " " + error);
+            continue;
+        }
+        job.cancelled = connection->addJob(id);
+        if (!job.cancelled) {
+            connection->send("ERROR " + id + " request already running");
+            continue;
+        }
+        job.connection = connection;
+        job.id = id;
+
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->queue.push_back(job);
+        this->queueCondition.notify_one();
+    }
+    if (connection->isLineTooLong()) {
+        connection->send("ERROR - line too long");
+    }
+}
+
+// Worker of the pool, solve the queued jobs one after another
+void Server::worker() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(this->queueMutex);
+            this->queueCondition.wait(lock, [this]() { return !this->queue.empty(); });
+            job = this->queue.front();
+            this->queue.pop_front();
+        }
+        solve(job);
+    }
+}
+
+// Send a tour of a job to its client
+static void sendTour(shared_ptr<Connection> connection, const string &id, int cost, const vector<int> &tour) {
+    ostringstream reply;
+    reply << "TOUR " << id << " " << cost;
+    for (int city : tour) {
+        reply << " " << city;
+    }
+    connection->send(reply.str());
+}
+
+// Solve a job, streaming the improved tours back to its client
+void Server::solve(Job &job) {
+    shared_ptr<Connection> connection = job.connection;
+    string id = job.id;
+
+    CacheEntry entry;
+    bool cached = this->results and this->results->lookup(*job.instance, entry);
+    if (cached and entry.optimal and !*job.cancelled and !connection->isClosed()) {
+        sendTour(connection, id, entry.cost, entry.tour);
+        connection->send("DONE " + id + " " + std::to_string(entry.cost) + " OPTIMAL");
+        connection->removeJob(id);
+        return;
+    }
+
+    Little<int> little(*job.instance);
+    little.setVerbose(false);
+    little.setSymmetric(true);      // kept asymmetric unless the costs are symmetric
+    if (cached and little.setInitialTour(entry.tour)) {
+        sendTour(connection, id, little.getCost(), little.getLastTour());
+    }
+    little.setTourCallback([connection, id](int cost, const vector<int> &tour) {
+        sendTour(connection, id, cost, tour);
+    });
+    little.setStopCondition([&job, connection]() {
+        return *job.cancelled or connection->isClosed() or
+               (job.hasDeadline and std::chrono::steady_clock::now() >= job.deadline);
+    });
+    little.findTour();
+
+    if (this->results) {
+        this->results->store(*job.instance, CacheEntry(little.isOptimal(), little.getCost(), little.getLastTour()));
+    }
+
+    ostringstream reply;
+    reply << "DONE " << id << " " << (little.getLastTour().empty() ? -1 : little.getCost()) << " ";
+    if (little.isOptimal()) {
+        reply << (little.getLastTour().empty() ? "INFEASIBLE" : "OPTIMAL");
+    }
+    else if (*job.cancelled or connection->isClosed()) {
+        reply << "CANCELLED";
+    }
+    else {
+        reply << "DEADLINE";
+    }
+    connection->send(reply.str());
+    connection->removeJob(id);
+}
+
+/*
+ * Return the parsed instance of a request, from the cache when its content
+ * has already been submitted, nullptr with an error message otherwise
+ */
+shared_ptr<Matrix<int> > Server::getInstance(const string &kind, int dimension, const string &content, string &error) {
+    // The request is kept with its instance, two requests may share a hash
+    string data = kind + '\n' + content;
+    uint64_t key = hash(data);
+    {
+        std::lock_guard<std::mutex> lock(this->cacheMutex);
+        if (this->cache.count(key) and this->cache[key].first == data) {
+            return this->cache[key].second;
+        }
+    }
+
+    shared_ptr<Matrix<int> > instance;
+    if (kind == "SOLVE") {
+        Tsplib tsp;
+        istringstream stream(content);
+        bool parsed;
+        try {
+            parsed = tsp.readProblem(stream);
+        }
+        catch (const std::exception &e) {
+            parsed = false;
+        }
+        if (!parsed) {
+            error = "invalid TSPlib problem";
+            return nullptr;
+        }
+        instance = make_shared<Matrix<int> >(tsp.getMatrix());
+    }
+    else {
+        instance = make_shared<Matrix<int> >(dimension, dimension, 999999999);
+        const char *costs = content.data();
+        for (int i = 0; i < dimension; i++) {
+            for (int j = 0; j < dimension; j++) {
+                int32_t cost;
+                memcpy(&cost, costs + (i * dimension + j) * sizeof(int32_t), sizeof(int32_t));
+                if (i != j) {
+                    instance->setValue(i, j, cost);
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    if (!this->cache.count(key)) {
+        if (this->cacheOrder.size() >= this->cacheCapacity) {
+            this->cache.erase(this->cacheOrder.front());
+            this->cacheOrder.pop_front();
+        }
+        this->cache[key] = std::make_pair(data, instance);
+        this->cacheOrder.push_back(key);
+    }
+    return instance;
+}
+
+// 64 bits FNV-1a hash of a request
+uint64_t Server::hash(const string &data) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
@@ -0,0 +1,110 @@
+#ifndef SERVER_H
+#define	SERVER_H
+
+#include "../Matrix/Matrix.h"
+#include <string>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using std::string;
+using std::map;
+using std::deque;
+using std::shared_ptr;
+using std::pair;
+
+class ResultCache;
+
+/*
+ * Long-running solver listening on a Unix domain socket.
+ *
+ * Requests (one per line, cities are numbered from 1) :
+ *   SOLVE <id> [<deadline ms>]          followed by a TSPlib problem ending with an EOF line
+ *   SOLVEBIN <id> <n> [<deadline ms>]   followed by n * n native int32 costs, row by row
+ *
+ * The connection is closed after an error in a problem, its end being unknown
+ *   CANCEL <id>
+ *
+ * Replies :
+ *   TOUR <id> <cost> <city> ...         each time a better tour is found
+ *   DONE <id> <cost> OPTIMAL|INFEASIBLE|DEADLINE|CANCELLED
+ *   ERROR <id> <message>
+ *
+ * The cost of DONE is -1 without any tour, INFEASIBLE meaning that each tour
+ * needs a missing segment. The requests of a client are cancelled as soon as
+ * it closes the connection
+ */
+
+// Client connection, shared between its reader thread and its running jobs
+class Connection {
+private:
+    int fd;
+    string buffer;                          // received but not consumed bytes
+    bool lineTooLong = false;               // a line exceeded maxLineLength, the connection cannot be read anymore
+    std::mutex writeMutex;
+    std::atomic<bool> closed;               // peer gone or done sending, its requests are cancelled
+    std::mutex jobsMutex;
+    map<string, shared_ptr<std::atomic<bool> > > cancelFlags;   // cancellation flag of each running request
+
+public:
+    static const size_t maxLineLength = 16 << 20;
+
+    Connection(int fd) : fd(fd), closed(false) {}
+    ~Connection();
+    bool readLine(string &line);
+    bool readBytes(size_t count, string &bytes);
+    void send(const string &message);
+    void shutdown();
+    bool isClosed() { return this->closed; }
+    bool isLineTooLong() { return this->lineTooLong; }
+    shared_ptr<std::atomic<bool> > addJob(const string &id);
+    void removeJob(const string &id);
+    bool cancelJob(const string &id);
+};
+
+// Request waiting for a worker
+struct Job {
+    shared_ptr<Connection> connection;
+    string id;
+    shared_ptr<Matrix<int> > instance;
+    shared_ptr<std::atomic<bool> > cancelled;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+class Server {
+private:
+    string socketPath;
+    int nbWorkers;
+    size_t cacheCapacity;                   // maximum number of parsed instances kept in memory
+    ResultCache *results = nullptr;         // on-disk cache of the solved instances, if any
+
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    deque<Job> queue;                       // jobs waiting for a worker
+
+    std::mutex cacheMutex;
+    map<uint64_t, pair<string, shared_ptr<Matrix<int> > > > cache;     // requests and their parsed instances by hash
+    deque<uint64_t> cacheOrder;             // insertion order, for eviction
+
+    void worker();
+    void serve(shared_ptr<Connection> connection);
+    void solve(Job &job);
+    shared_ptr<Matrix<int> > getInstance(const string &kind, int dimension, const string &content, string &error);
+    static uint64_t hash(const string &data);
+
+public:
+    static const size_t maxRequestSize = 256 << 20;     // bytes of a problem
+    static const int maxDimension = 8192;               // cities of a problem, n * n costs fitting in maxRequestSize
+
+    Server(string socketPath, int nbWorkers = 0, size_t cacheCapacity = 64);
+    void setCache(ResultCache *results) { this->results = results; }
+    bool run();
+};
+
+#endif	/* SERVER_H */
@@ -2,6 +2,9 @@
 #include <ctime>
 #include <algorithm>
 #include "../Little/Little.h"
+#include "../Little/Reoptimizer.h"
+#include "../Little/Decomposer.h"
+#include "../Cache/ResultCache.h"
 
 using std::cout;
 using std::endl;
@@ -9,27 +12,30 @@ using std::getline;
 using std::find;
 using std::stringstream;
 using std::stoi;
+using std::make_pair;
 
 // Called if there is only a input file, and no output file
-Tsplib::Tsplib(ifstream& inputFile) {
+Tsplib::Tsplib(istream& inputFile) {
     if (readProblem(inputFile)) {
+        solve();
         printSolution();
     }
 }
 
 // Called if there is a input and a ouput file
-Tsplib::Tsplib(ifstream& inputFile, ofstream& outputFile) {
+Tsplib::Tsplib(istream& inputFile, ostream& outputFile) {
     if (readProblem(inputFile)) {
+        solve();
         writeSolution(outputFile);
     }
 }
 
 /*
- * Read the submitted TSPlib file, return false on error,
+ * Read the submitted TSPlib problem, return false on error,
  * When parsing the TSP, return false on error
  * true otherwise
  */
-bool Tsplib::readProblem(ifstream& inputFile) {
+bool Tsplib::readProblem(istream& inputFile) {
     string line;
     bool isMatrix = 0;
     while(inputFile) {
@@ -57,19 +63,272 @@ bool Tsplib::readProblem(ifstream& inputFile) {
         }
     }
     
-    if (!fillMatrix()) {
-        return false;
+    return fillMatrix();
+}
+
+/*
+ * Solve the read problem with the Little algorithm,
+ * unless it is already known by the cache
+ */
+void Tsplib::solve() {
+    if (!this->edits.empty()) {
+        reoptimize();
+        return;
+    }
+
+    CacheEntry entry;
+    bool cached = false;
+    Matrix<int> matrix;     // expanded once for the cache
+    if (this->cache) {
+        matrix = getMatrix();
+        cached = this->cache->lookup(matrix, entry);
+    }
+    if (cached and entry.optimal) {
+        this->optimalTour = entry.tour;
+        this->cost = entry.cost;
+        this->optimal = true;
+        return;
+    }
+    if (this->clusterSize > 0) {
+        decompose();
+        return;
+    }
+
+    // A TSP is searched without the reverse of the tours
+    Little<int> little = this->symmetric ? Little<int>(this->symmetricMatrix) : Little<int>(this->matrix);
+    if (this->branchingRule) {
+        little.setBranchingRule(this->branchingRule);
+    }
+    little.setAssignmentBound(this->assignmentBound);
+    little.setMemoryLimit(this->memoryLimit);
+    if (this->kernelSize >= 0) {
+        little.setKernelSize(this->kernelSize);
+    }
+    if (this->transpositionTableSize > 0) {
+        little.setTranspositionTable(std::make_shared<TranspositionTable<int> >(this->transpositionTableSize));
+    }
+    if (cached) {
+        little.setInitialTour(entry.tour);      // warm start from the cached tour
+    }
+    if (!this->initialTour.empty()) {
+        little.setInitialTour(this->initialTour);   // warm start from the submitted tour
     }
-    
-    Little<int> little(this->matrix);
     little.findTour();
+    if (little.hasSpillFailed()) {
+        cout << "Error : Spill file cannot be written or read, the search is incomplete" << endl;
+    }
     
     this->optimalTour = little.getLastTour();
     this->cost = little.getCost();
-    
+    this->optimal = little.isOptimal();
+
+    if (this->cache) {
+        this->cache->store(matrix, CacheEntry(this->optimal, this->cost, this->optimalTour));
+    }
+}
+
+// Return the interpreted matrix, expanded for a symmetric TSP
+Matrix<int> Tsplib::getMatrix() {
+    return this->symmetric ? this->symmetricMatrix.toMatrix() : this->matrix;
+}
+
+// Set the solution found outside of solve, by a distributed search
+void Tsplib::setSolution(const vector<int> &tour, int cost, bool optimal) {
+    this->optimalTour = tour;
+    this->cost = cost;
+    this->optimal = optimal;
+}
+
+/*
+ * Read the tour to start the search from, checked by the search against
+ * the read problem, return false on error
+ */
+bool Tsplib::readInitialTour(istream& tourFile) {
+    vector<int> tour;
+    string comment;
+    if (!readTour(tourFile, tour, comment)) {
+        cout << "Error : Initial tour has no TOUR_SECTION" << endl;
+        return false;
+    }
+
+    Little<int> little = this->symmetric ? Little<int>(this->symmetricMatrix) : Little<int>(this->matrix);
+    if (!little.setInitialTour(tour)) {
+        cout << "Error : Initial tour is not a tour of the problem" << endl;
+        return false;
+    }
+
+#ifdef DEBUG
+    cout << "Initial tour cost " << little.getCost() << endl;
+#endif
+
+    this->initialTour = tour;
+    return true;
+}
+
+/*
+ * Read the edits to apply to the problem, one per line :
+ *   EDGE <from> <to> <cost>    (both directions for a TSP)
+ *   REMOVE <city>              (the next cities are renumbered)
+ *   ADD <n costs from the new city> <n costs to the new city>
+ * Return false on error
+ */
+bool Tsplib::readDelta(istream& deltaFile) {
+    string line;
+    int nbCities = this->dimension;
+    while (getline(deltaFile, line)) {
+        stringstream stream(line);
+        string kind;
+        if (!(stream >> kind) or kind == "EOF") {
+            continue;
+        }
+
+        vector<int> values;
+        int value;
+        while (stream >> value) {
+            values.push_back(value);
+        }
+
+        bool valid = false;
+        if (kind == "EDGE") {
+            valid = values.size() == 3 and values[0] >= 1 and values[0] <= nbCities and
+                    values[1] >= 1 and values[1] <= nbCities and values[0] != values[1];
+        }
+        else if (kind == "REMOVE") {
+            valid = values.size() == 1 and values[0] >= 1 and values[0] <= nbCities and nbCities > 3;
+            nbCities--;
+        }
+        else if (kind == "ADD") {
+            valid = values.size() == 2 * nbCities;
+            nbCities++;
+        }
+        if (!valid) {
+            cout << "Error : Invalid delta line " << line << endl;
+            return false;
+        }
+        this->edits.push_back(make_pair(kind, values));
+    }
     return true;
 }
 
+/*
+ * Apply the edits to the problem and re-optimize the initial tour,
+ * the problem becomes the edited one
+ */
+void Tsplib::reoptimize() {
+    Reoptimizer<int> reoptimizer(getMatrix(), this->initialTour, this->initialOptimal);
+    for (const pair<string, vector<int> > &edit : this->edits) {
+        const vector<int> &values = edit.second;
+        if (edit.first == "EDGE") {
+            if (this->type == "TSP") {
+                reoptimizer.setSymmetricCost(values[0], values[1], values[2]);
+            }
+            else {
+                reoptimizer.setCost(values[0], values[1], values[2]);
+            }
+        }
+        else if (edit.first == "REMOVE") {
+            reoptimizer.removeCity(values[0]);
+        }
+        else {
+            int half = values.size() / 2;
+            reoptimizer.addCity(vector<int>(values.begin(), values.begin() + half),
+                                vector<int>(values.begin() + half, values.end()));
+        }
+    }
+
+    reoptimizer.reoptimize(this->nodeLimit);
+    this->matrix = reoptimizer.getMatrix();
+    this->symmetric = false;       // the edits may break the symmetry
+    this->symmetricMatrix = SymmetricMatrix<int>();
+    this->dimension = this->matrix.getNbRows();
+    this->optimalTour = reoptimizer.getTour();
+    this->cost = reoptimizer.getCost();
+    this->optimal = reoptimizer.isOptimal();
+
+#ifdef DEBUG
+    cout << "Re-optimization : " << reoptimizer.getNbNodes() << " nodes, optimality "
+         << (this->optimal ? "proven" : "not proven") << endl;
+#endif
+
+    if (this->cache) {
+        this->cache->store(this->matrix, CacheEntry(this->optimal, this->cost, this->optimalTour));
+    }
+}
+
+/*
+ * Build a tour by the decomposition into clusters, too large problems for
+ * an exact search, compared to the nearest neighbour and local search tour
+ */
+void Tsplib::decompose() {
+    Matrix<int> matrix = getMatrix();
+    Decomposer<int> decomposer(matrix, this->clusterSize);
+    decomposer.solve();
+    decomposer.solveBaseline();
+
+    this->optimalTour = decomposer.getTour();
+    this->cost = decomposer.getTourCost(this->optimalTour);
+    this->optimal = false;
+    int baselineCost = decomposer.getTourCost(decomposer.getBaselineTour());
+    if (baselineCost < this->cost) {
+        this->optimalTour = decomposer.getBaselineTour();      // the better of both tours is kept
+        this->cost = baselineCost;
+    }
+    if (this->cost == matrix.getEmptyValue()) {
+        this->optimalTour.clear();      // no tour of finite cost found, as Little
+        this->cost = std::numeric_limits<int>::max();
+    }
+
+#ifdef DEBUG
+    cout << "Decomposition : " << decomposer.getNbClusters() << " clusters of at most " << this->clusterSize
+         << " cities, " << decomposer.getNbNodes() << " nodes, cost " << decomposer.getTourCost(decomposer.getTour())
+         << " in " << decomposer.getSeconds() << " s" << endl;
+    cout << "Searches stopped by their node limit : " << decomposer.getNbTruncated() << " of "
+         << decomposer.getNbClusters() << " cluster paths, cluster order " << (decomposer.isOrderTruncated() ? "yes" : "no") << endl;
+    cout << "Baseline (nearest neighbour, 2-opt, Or-opt) : cost " << baselineCost << " in "
+         << decomposer.getBaselineSeconds() << " s, decomposition "
+         << 100.0 * (decomposer.getTourCost(decomposer.getTour()) - baselineCost) / baselineCost << " % from it" << endl;
+#endif
+
+    if (this->cache) {
+        this->cache->store(matrix, CacheEntry(this->optimal, this->cost, this->optimalTour));
+    }
+}
+
+/*
+ * Read a TSPlib tour, return false on error,
+ * the COMMENT value is returned as it may carry the tour length
+ */
+bool Tsplib::readTour(istream& inputFile, vector<int>& tour, string& comment) {
+    string line;
+    bool isTour = false;
+    tour.clear();
+    while (getline(inputFile, line)) {
+        line = trim(line);
+        if (line == "EOF") {
+            break;
+        }
+        if (isTour) {
+            stringstream stream(line);
+            int city;
+            while (stream >> city) {
+                if (city == -1) {
+                    return !tour.empty();
+                }
+                tour.push_back(city);
+            }
+        }
+        else if (line == "TOUR_SECTION") {
+            isTour = true;
+        }
+        else if (line.find(':') != string::npos) {
+            if (trim(line.substr(0, line.find(':'))) == "COMMENT") {
+                comment = trim(line.substr(line.find(':') + 1));
+            }
+        }
+    }
+    return !tour.empty();
+}
+
 // Check and store the value of each keyword
 bool Tsplib::checkKeyword(string keyword, string value) {
     if (keyword == "NAME") {
@@ -150,7 +409,7 @@ void Tsplib::printSolution() {
 }
 
 // Write the solution in the specified output
-void Tsplib::writeSolution(ofstream& outputFile) {
+void Tsplib::writeSolution(ostream& outputFile) {
     time_t now = time(0);
     tm* localtm = localtime(&now);
     
@@ -169,11 +428,36 @@ void Tsplib::writeSolution(ofstream& outputFile) {
 
 // Call the matrix parser function corresponding to the submitted matrix type
 bool Tsplib::fillMatrix() {
-    Matrix<int> matrix(this->dimension, this->dimension, 999999999);
-    this->matrix = matrix;
+    if (this->dimension < 3) {
+        cout << "Error : DIMENSION must be at least 3" << endl;
+        return false;
+    }
+
+    int n = this->dimension;
+    int expected = n * n;
+    if ((edgeWeightFormat == "UPPER_ROW") or (edgeWeightFormat == "LOWER_COL") or
+            (edgeWeightFormat == "LOWER_ROW") or (edgeWeightFormat == "UPPER_COL")) {
+        expected = n * (n - 1) / 2;
+    }
+    if ((edgeWeightFormat == "UPPER_DIAG_ROW") or (edgeWeightFormat == "LOWER_DIAG_COL") or
+            (edgeWeightFormat == "LOWER_DIAG_ROW") or (edgeWeightFormat == "UPPER_DIAG_COL")) {
+        expected = n * (n + 1) / 2;
+    }
+    if (this->numbers.size() < expected) {
+        cout << "Error : EDGE_WEIGHT_SECTION holds " << this->numbers.size() << " values, " << expected << " expected" << endl;
+        return false;
+    }
+
+    /* The triangular formats are read in a symmetric matrix,
+     * only kept as such for a TSP and expanded otherwise */
     if (edgeWeightFormat == "FULL_MATRIX") {
+        this->matrix = Matrix<int>(this->dimension, this->dimension, 999999999);
         fullMatrix();
     }
+    else {
+        this->symmetricMatrix = SymmetricMatrix<int>(this->dimension, 999999999);
+        this->symmetric = true;
+    }
     if ((edgeWeightFormat == "UPPER_ROW") or (edgeWeightFormat == "LOWER_COL")) {
         upperRow();
     }
@@ -186,10 +470,38 @@ bool Tsplib::fillMatrix() {
     if ((edgeWeightFormat == "LOWER_DIAG_ROW") or (edgeWeightFormat == "UPPER_DIAG_COL")) {
         lowerDiagRow();
     }
-    
+    vector<int>().swap(this->numbers);      // the read values are not needed anymore
+
+    if (this->type == "TSP" and !this->symmetric) {
+        packMatrix();
+    }
+    else if (this->type != "TSP" and this->symmetric) {
+        this->matrix = this->symmetricMatrix.toMatrix();
+        this->symmetricMatrix = SymmetricMatrix<int>();
+        this->symmetric = false;
+    }
     return true;
 }
 
+// Keep a full matrix read for a TSP in a symmetric one, unless its costs are not symmetric
+void Tsplib::packMatrix() {
+    for (int i = 0; i < this->dimension; i++) {
+        for (int j = 0; j < i; j++) {
+            if (this->matrix.getValue(i, j) != this->matrix.getValue(j, i)) {
+                return;
+            }
+        }
+    }
+    this->symmetricMatrix = SymmetricMatrix<int>(this->dimension, 999999999);
+    for (int i = 0; i < this->dimension; i++) {
+        for (int j = 0; j < i; j++) {
+            this->symmetricMatrix.setValue(i, j, this->matrix.getValue(i, j));
+        }
+    }
+    this->matrix = Matrix<int>();
+    this->symmetric = true;
+}
+
 // Full matrix parser
 void Tsplib::fullMatrix() {
     for (int i = 0; i < this->dimension; i++) {
@@ -206,8 +518,7 @@ void Tsplib::upperRow(){
     int counter = 0;
     for (int i = 0; i < this->dimension - 1; i++) {
         for (int j = i + 1; j < this->dimension; j++) {
-            matrix.setValue(i, j, this->numbers[counter]);
-            matrix.setValue(j, i, this->numbers[counter]);
+            symmetricMatrix.setValue(i, j, this->numbers[counter]);
             counter++;
         }
     }
@@ -218,8 +529,7 @@ void Tsplib::lowerRow(){
     int counter = 0;
     for (int i = 1; i < this->dimension; i++) {
         for (int j = 0; j < i; j++) {
-            matrix.setValue(i, j, this->numbers[counter]);
-            matrix.setValue(j, i, this->numbers[counter]);
+            symmetricMatrix.setValue(i, j, this->numbers[counter]);
             counter++;
         }
     }
@@ -231,8 +541,7 @@ void Tsplib::upperDiagRow(){
     for (int i = 0; i < this->dimension; i++) {
         for (int j = i; j < this->dimension; j++) {
             if (i != j) {
-                matrix.setValue(i, j, this->numbers[counter]);
-                matrix.setValue(j, i, this->numbers[counter]);
+                symmetricMatrix.setValue(i, j, this->numbers[counter]);
             }
             counter++;
         }
@@ -245,8 +554,7 @@ void Tsplib::lowerDiagRow(){
     for (int i = 0; i < this->dimension; i++) {
         for (int j = 0; j < i + 1; j++) {
             if (j != i) {
-                matrix.setValue(i, j, this->numbers[counter]);
-                matrix.setValue(j, i, this->numbers[counter]);
+                symmetricMatrix.setValue(i, j, this->numbers[counter]);
             }
             counter++;
         }
@@ -5,10 +5,20 @@
 #include <iostream>
 #include <fstream>
 #include "../Matrix/Matrix.h"
+#include "../Matrix/SymmetricMatrix.h"
+#include <utility>
+#include <memory>
+
+using std::pair;
+
+class ResultCache;
+template<class T> class BranchingRule;
 
 using std::string;
+using std::istream;
 using std::ifstream;
 using std::ofstream;
+using std::ostream;
 
 class Tsplib {
 private:
@@ -17,21 +27,35 @@ private:
     string name;
     string type;
     string comment;
-    int dimension;
+    int dimension = 0;
     string edgeWeightType;
     string edgeWeightFormat;
     
     vector<int> numbers;    // Submitted matrix in the TSP file, on only one line
     Matrix<int> matrix;     // Interpreted Matrix, usable for the Little algorithm
+    SymmetricMatrix<int> symmetricMatrix;   // Interpreted Matrix of a symmetric TSP, each cost stored once until the search
+    bool symmetric = false;     // Whether the problem is kept in symmetricMatrix instead of matrix
+    vector<int> initialTour;    // Submitted tour to start the search from, if any
+    vector<pair<string, vector<int> > > edits;  // Edits of the problem to re-optimize the initial tour for
+    bool initialOptimal = false;    // Whether the initial tour is optimal before the edits
+    long nodeLimit = 0;     // Maximum number of nodes of the re-optimization search, 0 for no limit
     vector<int> optimalTour;    // Optimal tour found thanks to the Little algorithm
     int cost;   // Cost of the found tour
+    bool optimal = false;   // Whether the found tour is proven optimal
+    ResultCache *cache = nullptr;   // Cache of the already solved problems, if any
+    std::shared_ptr<BranchingRule<int> > branchingRule;    // Branching rule of the search, the default one if null
+    bool assignmentBound = false;   // Bound by the assignment problem instead of the reduction
+    size_t memoryLimit = 0;     // Bytes of the open nodes kept in memory by the search, 0 for no limit
+    size_t transpositionTableSize = 0;  // Bytes of the table of the subproblems already reached, 0 for none
+    int kernelSize = -1;        // Largest subproblem searched by the fixed size kernels, 0 for none, -1 for the default
+    int clusterSize = 0;        // Largest cluster of the decomposition into clusters, 0 for an exact search
     
     bool checkKeyword(string, string);
-    string trim(string);
-    bool readProblem(ifstream&);
-    void printSolution();
-    void writeSolution(ofstream&);
+    static string trim(string);
     bool fillMatrix();
+    void reoptimize();
+    void decompose();
+    void packMatrix();
     void fullMatrix();
     void upperRow();
     void lowerRow();
@@ -39,8 +63,29 @@ private:
     void lowerDiagRow();
     
 public:
-    Tsplib(ifstream&);
-    Tsplib(ifstream&, ofstream&);
+    Tsplib() {}
+    Tsplib(istream&);
+    Tsplib(istream&, ostream&);
+    bool readProblem(istream&);
+    void setCache(ResultCache *cache) { this->cache = cache; }
+    bool readInitialTour(istream&);
+    bool readDelta(istream&);
+    bool hasDelta() { return !this->edits.empty(); }
+    void setInitialOptimal(bool initialOptimal) { this->initialOptimal = initialOptimal; }
+    void setNodeLimit(long nodeLimit) { this->nodeLimit = nodeLimit; }
+    void setBranchingRule(std::shared_ptr<BranchingRule<int> > rule) { this->branchingRule = rule; }
+    void setAssignmentBound(bool assignmentBound) { this->assignmentBound = assignmentBound; }
+    void setMemoryLimit(size_t memoryLimit) { this->memoryLimit = memoryLimit; }
+    void setTranspositionTableSize(size_t size) { this->transpositionTableSize = size; }
+    void setKernelSize(int size) { this->kernelSize = size; }
+    void setClusterSize(int size) { this->clusterSize = size; }
+    void solve();
+    void setSolution(const vector<int> &tour, int cost, bool optimal);
+    vector<int> getInitialTour() { return this->initialTour; }  // Return the submitted initial tour, if any
+    void printSolution();
+    void writeSolution(ostream&);
+    Matrix<int> getMatrix();
+    static bool readTour(istream&, vector<int>&, string&);
 };
 
 #endif	/* TSPLIB_H */
\ No newline at end of file